@@ -9,12 +9,13 @@
 #define __DFA_HPP__
 
 #include <unordered_set>
-#include <map>
 #include <vector>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include "alphabet.hpp"
+#include "transitions.hpp"
+#include "signatures.hpp"
 
 /// @brief Klasse zur Repräsentation von deterministischen Endlichen Automaten
 class DFA
@@ -22,6 +23,28 @@ class DFA
 
   //forward Declaration der Klasse für die Minimierung als Freund der DFAs
   friend class Hopcroft;
+  //und der Klasse für den inkrementellen Aufbau
+  friend class Daciuk;
+  //und der Klasse zum schnellen Einlesen von tfsm-Dateien
+  friend class TfsmReader;
+  //und der Klasse für das Binärformat
+  friend class BinaryFormat;
+  //und dem Erkenner für schnelle Abfragen
+  friend class Recognizer;
+  //und dem perfekten Hashing
+  friend class PerfectHash;
+  //und dem parallelen Aufbau aus Teilautomaten
+  friend class ShardedBuilder;
+  //und dem Entfernen unerreichbarer und toter Zustände
+  friend class Trimmer;
+  //und dem Vergleich zweier Automaten
+  friend class Equivalence;
+  //und der Potenzmengenkonstruktion aus einem NFA
+  friend class SubsetConstruction;
+  //und den Produktautomaten
+  friend class Product;
+  //und der Neunummerierung für bessere Lokalität
+  friend class Renumbering;
 
   public:
 
@@ -30,55 +53,11 @@ class DFA
     init();
   }
   
-  /** @brief Ein Konstruktor der eine Datei in FSM2's at&t-Format einliest
+  /** @brief Ein Konstruktor der eine Datei in FSM2's at&t-Format einliest.
+             Der Inhalt wird wie mit TfsmReader geparst und aufgebaut (siehe dort)
       @param in ein ifstream einer Datei in FSM2's at&t-Format
   */
-  DFA(std::ifstream& in){
-    init();
-    unsigned n,m;
-    char c;
-    bool firstline = true;
-    std::string line;
-    std::string token;
-    std::vector<std::string> tokens;
-    while(std::getline(in,line)){
-      line+='\t';
-      //Tokenisierung
-      for(int i = 0;i!=line.size();++i){
-        if(line[i] != '\t'){
-          token+=line[i];
-        }
-        else{
-          tokens.push_back(token);
-          token.clear();
-        }
-      }
-      //Wenn es auf der Zeile nur ein Token gibt...
-      if(tokens.size()==1){
-        //handelt es sich um einen Endzustand
-        final_states.insert(atoi(tokens[0].c_str()));
-        enlarge(atoi(tokens[0].c_str()));
-        signatures[atoi(tokens[0].c_str())] += 63;
-      }
-      else{
-        //Der erste Zustand der ersten Zeile ist der Startzustand
-        if(firstline){
-          firstline=false;
-          start_state=atoi(tokens[0].c_str());
-          enlarge(atoi(tokens[0].c_str()));
-        }
-        //Einfügen des Alphabetsymbols, Vergrößern der Container, Hinzufügen des Übergangs
-        //Aktualisierung der Signatur
-        alphabet.add(tokens[2][0]);
-        enlarge(atoi(tokens[1].c_str()));
-        enlarge(atoi(tokens[0].c_str()));
-        transitions[atoi(tokens[0].c_str())][tokens[2][0]] = atoi(tokens[1].c_str());
-        transition_count++;
-        signatures[atoi(tokens[0].c_str())] += alphabet[tokens[2][0]];
-        }
-      tokens.clear();
-    }
-  }
+  DFA(std::ifstream& in);
   
   /** @brief Fügt dem Automaten ein Wort hinzu
       @param str Das Wort in Form eines std::string
@@ -87,29 +66,27 @@ class DFA
     unsigned current_state=start_state;
     //Schleife über das Wort
 	  for(int i=0; i<str.length();i++){
+      unsigned next_state = transitions.find(current_state,str[i]);
       //Wenn es keinen Übergang mit dem derzeitigen Zeichen gibt...
-      if(transitions[current_state].find(str[i])==transitions[current_state].end()){
+      if(next_state==Transitions::NONE){
         //Hinzufügen des Übergangs und Erweiterung der Signatur
         alphabet.add(str[i]);
-        transitions[current_state][str[i]] = state_count;
-        signatures[current_state] += alphabet[str[i]];
+        transitions.set(current_state,str[i],state_count);
+        signatures.add(current_state,alphabet[str[i]]);
         //Hinzufügen des neuen Zustands
-        //TODO: Eine Funktion schreiben, die immer wenn die Kapazität
-        //des Vektors erreicht ist, eine bestimmte Menge Platz reserviert
-        //um ständige Reallokation zu verhindern
-        transitions.push_back(std::map<char,unsigned>());
-        signatures.push_back(Signature());
+        transitions.push_back();
+        signatures.push_back();
         current_state = state_count;
         ++state_count;
         ++transition_count;
       }
       //Wenn es einen Übergang mit dem derzeitigen Zeichen gibt...
       else{
-        current_state = transitions[current_state][str[i]];  
+        current_state = next_state;
       }
     }
     final_states.insert(current_state);
-    signatures[current_state] += 63;
+    signatures.set_final(current_state);
   }
   
   /** @brief Schreibt den Automaten im dot-Format in eine Datei
@@ -133,14 +110,118 @@ class DFA
     }
     //Übergänge
     for(int i = 0;i!=state_count;++i){
-      for(auto it=transitions[i].begin();it!=transitions[i].end();++it){
-        o << i << "  -> " << it->second << "  [ label = \"" << it->first << "\" ];\n\t";
+      for(unsigned j=transitions.begin(i);j!=transitions.end(i);++j){
+        o << i << "  -> " << transitions.target(j) << "  [ label = \"" << transitions.symbol(j) << "\" ];\n\t";
       }
     }
     //Fußzeile
     o << "\n}";	
   }
   
+  /// @brief Die Form des erzeugten Erkenners von generate()
+  enum CodeStyle{
+    SWITCH, ///< Eine Funktion je Zustand mit einem switch über das nächste Byte (direct threading)
+    TABLES ///< Konstante Tabellen (constexpr) der Übergänge und eine Schleife
+  };
+  
+  /** @brief Schreibt einen eigenständigen C++-Erkenner für den Automaten in eine Datei
+  
+      Die Datei ist ein Header ohne Abhängigkeiten außer der Standardbibliothek und
+      definiert bool name(const char* word, std::size_t length) sowie
+      bool name(const std::string& word). Gedacht für feste, minimierte Automaten,
+      die der Compiler so vollständig spezialisieren kann.
+      @param filename Der Name der Datei
+      @param name optional: der Name der Funktion. Default = "recognize"
+      @param style optional: SWITCH oder TABLES. Default = SWITCH
+  */
+  void generate(std::string filename, std::string name = "recognize", CodeStyle style = SWITCH){
+    std::ofstream o(filename.c_str());
+    o << "// Erzeugt von DFA::generate: " << state_count << " Zustände, " << transition_count << " Übergänge\n"
+      << "#ifndef __" << name << "_GENERATED__\n#define __" << name << "_GENERATED__\n\n"
+      << "#include <cstddef>\n#include <string>\n\n";
+    if(style == TABLES){
+      o << "namespace " << name << "_tables{\n"
+        << "static constexpr unsigned start = " << start_state << ";\n"
+        << "static constexpr unsigned offsets[] = {";
+      //Die Zeilen werden lückenlos hintereinander geschrieben
+      unsigned k = 0;
+      for(unsigned i = 0;i!=state_count;k+=transitions.degree(i),++i) o << (i ? "," : "") << (i % 16 ? "" : "\n  ") << k;
+      o << ",\n  " << k << "};\n"
+        << "static constexpr unsigned char symbols[] = {";
+      k = 0;
+      for(unsigned i = 0;i!=state_count;++i){
+        for(unsigned j = transitions.begin(i);j!=transitions.end(i);++j,++k) o << (k ? "," : "") << (k % 16 ? "" : "\n  ") << (unsigned)(unsigned char)transitions.symbol(j);
+      }
+      o << (k ? "" : "0") << "};\n"
+        << "static constexpr unsigned targets[] = {";
+      k = 0;
+      for(unsigned i = 0;i!=state_count;++i){
+        for(unsigned j = transitions.begin(i);j!=transitions.end(i);++j,++k) o << (k ? "," : "") << (k % 16 ? "" : "\n  ") << transitions.target(j);
+      }
+      o << (k ? "" : "0") << "};\n"
+        << "static constexpr bool finals[] = {";
+      for(unsigned i = 0;i!=state_count;++i) o << (i ? "," : "") << (i % 32 ? "" : "\n  ") << (final_states.count(i) ? 1 : 0);
+      o << "};\n}\n\n"
+        << "inline bool " << name << "(const char* word, std::size_t length){\n"
+        << "  using namespace " << name << "_tables;\n"
+        << "  unsigned s = start;\n"
+        << "  for(std::size_t i = 0;i!=length;++i){\n"
+        << "    unsigned char c = (unsigned char)word[i];\n"
+        << "    unsigned j = offsets[s], end = offsets[s+1];\n"
+        << "    while(j != end && symbols[j] < c) ++j;\n"
+        << "    if(j == end || symbols[j] != c) return false;\n"
+        << "    s = targets[j];\n"
+        << "  }\n"
+        << "  return finals[s];\n"
+        << "}\n\n";
+    }
+    else{
+      //Eine Funktion je Zustand statt Sprungmarken in einer einzigen Funktion: die
+      //Aufrufe am Ende werden vom Optimierer zu Sprüngen, und große Automaten
+      //bleiben übersetzbar
+      o << "namespace " << name << "_states{\n";
+      for(unsigned i = 0;i!=state_count;++i) o << "static bool s" << i << "(const char* word, const char* end);\n";
+      for(unsigned i = 0;i!=state_count;++i){
+        bool final = final_states.count(i) != 0;
+        o << "static bool s" << i << "(const char* word, const char* end){\n";
+        if(!transitions.degree(i)) o << "  return " << (final ? "word == end" : "false") << ";\n}\n";
+        else{
+          o << "  if(word == end) return " << (final ? "true" : "false") << ";\n"
+            << "  switch((unsigned char)*word++){\n";
+          for(unsigned j = transitions.begin(i);j!=transitions.end(i);++j){
+            o << "    case " << (unsigned)(unsigned char)transitions.symbol(j) << ": return s" << transitions.target(j) << "(word,end);\n";
+          }
+          o << "    default: return false;\n  }\n}\n";
+        }
+      }
+      o << "}\n\n"
+        << "inline bool " << name << "(const char* word, std::size_t length){\n"
+        << "  return " << name << "_states::s" << start_state << "(word,word + length);\n"
+        << "}\n\n";
+    }
+    o << "inline bool " << name << "(const std::string& word){\n"
+      << "  return " << name << "(word.data(),word.size());\n"
+      << "}\n\n#endif\n";
+  }
+  
+  /** @brief Baut eine dichte Übergangstabelle mit einer Spalte je Alphabetsymbol auf.
+             Lohnt sich für kleine Alphabete, wenn viele Übergänge nachgeschlagen werden.
+      @param dense Die zu füllende Tabelle
+  */
+  void densify(DenseTransitions& dense){
+    dense.build(transitions,alphabet.size(),[this](char c){ return alphabet[c]; });
+  }
+  
+  ///@brief Die Anzahl der Zustände
+  unsigned number_of_states() const{
+    return state_count;
+  }
+  
+  ///@brief Die Anzahl der Übergänge
+  unsigned number_of_transitions() const{
+    return transition_count;
+  }
+  
   ///@brief <<Operator um einige Parameter des Automaten auszugeben
   friend std::ostream& operator<<(std::ostream& o, const DFA& l)
   {
@@ -150,55 +231,13 @@ class DFA
   
   private:
   
-  ///	@brief private Funktion zur Vergrößerung des Automaten während dem Einlesen einer Datei
-  void enlarge(unsigned n){
-    if(n >= state_count){
-      state_count = n+1;
-      signatures.resize(state_count,Signature());
-      transitions.resize(state_count,std::map<char,unsigned>());
-    }
-  }
-  
-  /** @brief Eine Signatur, die widerspiegelt für welche Zeichen ein Zustand Übergänge besitzt
-             und ob er ein Endzustand ist
-  */
-  struct Signature{
-    Signature(){
-      sig = 0;
-    }
-    //fügt der Signatur das dem Index entsprechende Zeichen hinzu
-    void operator+=(unsigned i){
-      if(i < 64){
-        sig |= (1 << i);
-      }
-      else{
-        std::cerr << "Error: index is too big.\n";
-      }
-    }
-    
-    bool operator<(Signature& rhs){
-      return sig < rhs.sig;
-    }
-    
-    bool operator!=(Signature& rhs){
-      return sig != rhs.sig;
-    }
-    
-    bool operator==(Signature& rhs){
-      return sig == rhs.sig;
-    }
-    
-    //Ein Long (stellt hier quasi einen Boolvektor dar)
-    long sig;
-  };
-  
   /// @brief Initialisierungsfunktion
   void init(){
     start_state = 0;
     transition_count = 0;
     state_count = 1;
-    signatures.push_back(Signature());
-    transitions.push_back(std::map<char,unsigned>());
+    signatures.push_back();
+    transitions.push_back();
   }
   
   /// @brief private Hilfsfunktion zur Ausgabe des Automaten auf einem ostream
@@ -207,17 +246,24 @@ class DFA
     o << "acceptor, "
       << state_count << " states, "
       << transition_count << " transitions, "
-      << final_states.size() << " final states";
+      << final_states.size() << " final states, "
+      << memory() / (state_count ? state_count : 1) << " bytes per state";
+  }
+  
+  /// @brief private Hilfsfunktion, die den Speicherbedarf der Übergänge und Signaturen schätzt
+  std::size_t memory() const
+  {
+    return transitions.memory() + signatures.memory();
   }
   
   //Eine Klasse zur Indexierung der Alphabetszeichen
   Alphabet alphabet; ///< Alphabet zur Indexierung
   
-  //Die Signaturen der Zustände
-  std::vector<Signature> signatures; ///< Die Signaturen aller Zustände
+  //Die Signaturen der Zustände, breit genug für das Alphabet
+  Signatures signatures; ///< Die Signaturen aller Zustände
   
   //Die  Übergänge der Zustände
-  std::vector<std::map<char,unsigned>> transitions; ///< Die Übergänge aller Zustände als Maps von Char auf Zielzustände
+  Transitions transitions; ///< Die Übergänge aller Zustände, zeilenweise nach Symbolen sortiert
   
   unsigned start_state; ///< Der Startzustand
   unsigned transition_count; ///< Die Anzahl an Übergängen
@@ -226,11 +272,15 @@ class DFA
   //Eine Menge der Enzustände um schnell herauszufinden
   //ob ein Zustand ein Endzustand ist. 
   //TODO/Redundant: Man könnte gucken ob in der Signatur
-  //das Bit für die Endzustandsmarkierung(63) gesetzt ist.
+  //das Bit für die Endzustandsmarkierung (0) gesetzt ist.
   std::unordered_set<unsigned> final_states; ///< Eine Menge der Endzustände
 
 };
 
+#include "trim.hpp"
+#include "renumber.hpp"
 #include "hopcroft.hpp"
+//Für DFA(std::ifstream&)
+#include "tfsm.hpp"
 
 #endif
\ No newline at end of file
@@ -6,19 +6,24 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <vector>
-#include <map>
+#include <iostream>
 
-///@brief Klasse zum Abbilden eines Alphabets auf Zahlen
+/** @brief Klasse zum Abbilden eines Alphabets auf Zahlen
+
+    Symbole sind Bytes; UTF-8-Text wird byteweise verarbeitet, ein Zeichen
+    außerhalb von ASCII ergibt also mehrere Übergänge hintereinander.
+*/
 class Alphabet{
 	
 public:
 
 /** @brief Konstruktor der Klasse
     @param n optional: ein unsigned um die maximale Größe des Alphabets
-                       festzulegen. Default = 63
+                       festzulegen. Default = 256 (alle Bytes)
 */
-Alphabet(unsigned n=63){
-	max_alphabet_size = n;
+Alphabet(unsigned n=256){
+	max_alphabet_size = n < 256 ? n : 256;
+	for(unsigned c = 0;c!=256;++c) char_to_index[c] = ~0u;
 }
 
 /** @brief Operator [] nimmt ein Symbol in Form eines char und gibt
@@ -26,7 +31,7 @@ Alphabet(unsigned n=63){
     @param c ein Symbol als char
 */
 unsigned operator[](const char& c){
-	return char_to_index[c];
+	return char_to_index[(unsigned char)c];
 }
 
 /** @brief Operator [] nimmt einen Index in Form eines unsigned und gibt
@@ -37,18 +42,27 @@ char operator[](const unsigned& n){
 	return index_to_char[n];
 }
 
+/** @brief Gibt das Symbol zu einem Index zurück, ohne das Alphabet zu verändern
+    @param n ein Index kleiner als size()
+*/
+char symbol(unsigned n) const{
+	return index_to_char[n];
+}
+
+///@brief Gibt die Anzahl der Symbole im Alphabet zurück
+unsigned size() const{
+	return index_to_char.size();
+}
+
 /** @brief Fügt dem Alphabet ein Symbol hinzu und weist ihm einen Index zu.
            War das Symbol bereits enthalten, passiert nichts.
     @param c ein Symbol als char
 */
-void add(char& c){
-	if(!(index_to_char.size()==max_alphabet_size)){
-    if(char_to_index.find(c)==char_to_index.end()){
-      if(index_to_char.size() < max_alphabet_size){
-        char_to_index[c]= index_to_char.size();
-        index_to_char.push_back(c);
-      }
-    }
+void add(const char& c){
+  if(char_to_index[(unsigned char)c] != ~0u) return;
+	if(index_to_char.size() < max_alphabet_size){
+    char_to_index[(unsigned char)c] = index_to_char.size();
+    index_to_char.push_back(c);
   }
   else{
 		std::cerr << "Error: Alphabet is too big for this Instance to handle!\n";
@@ -57,7 +71,7 @@ void add(char& c){
 
 private:
 
-std::map<char,unsigned> char_to_index; ///< Eine Map die Symbole auf Indexe abbildet
+unsigned char_to_index[256]; ///< Bildet jedes Byte auf seinen Index ab (~0u wenn nicht enthalten)
 std::vector<char> index_to_char; ///< Ein Vektor der einen Index auf ein Symbol abbildet
 unsigned max_alphabet_size; ///< Die maximale Größe des Alphabets
 	
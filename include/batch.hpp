@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+// batch.hpp
+// Klasse für das Hopcroft Projekt
+// Minimierung vieler (kleiner) Automaten auf einmal
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BATCH_HPP__
+#define __BATCH_HPP__
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include "DFA.hpp"
+#include "parallel.hpp"
+
+/** @brief Minimiert viele Automaten, parallel über die Automaten statt innerhalb
+
+    Für einen Automaten mit wenigen Zuständen kostet das Verteilen der Arbeit
+    innerhalb von Hopcroft mehr als die Arbeit selbst. Automaten unterhalb der
+    Schwelle werden daher je auf einem Arbeiter seriell minimiert (SerialScope),
+    während der Pool viele gleichzeitig bearbeitet; die Arbeiter holen sich die
+    Automaten einzeln über einen gemeinsamen Zähler, so dass sich unterschiedlich
+    große Automaten ausgleichen. Jeder Arbeiter besitzt eine eigene Hopcroft-Instanz,
+    deren Hilfsvektoren von Automat zu Automat (und von Aufruf zu Aufruf)
+    wiederverwendet werden. Automaten ab der Schwelle werden danach einzeln mit
+    der Parallelität innerhalb von Hopcroft minimiert.
+*/
+class BatchMinimizer{
+
+  public:
+
+  /** @brief Der Konstruktor der Klasse
+      @param e optional: das Verfahren zur Verfeinerung. Default = MOORE
+      @param t optional: die Schwelle in Zuständen, ab der ein Automat für sich parallel minimiert wird. Default = 65536
+  */
+  BatchMinimizer(Hopcroft::Engine e = Hopcroft::MOORE, unsigned t = 65536){
+    engine = e;
+    threshold = t;
+    merge_symbols = false;
+    trim_states = true;
+    small = large = 0;
+    seconds = 0;
+  }
+
+  /** @brief Legt die Schwelle fest
+      @param t die Anzahl der Zustände, ab der ein Automat für sich parallel minimiert wird
+  */
+  void set_threshold(unsigned t){
+    threshold = t;
+  }
+
+  /** @brief Schaltet das Zusammenfassen gleichwertiger Symbole ein oder aus, siehe Hopcroft
+      @param on true zum Einschalten
+  */
+  void set_symbol_classes(bool on){
+    merge_symbols = on;
+  }
+
+  /** @brief Schaltet das Entfernen unerreichbarer und toter Zustände ein oder aus, siehe Hopcroft
+      @param on true zum Einschalten
+  */
+  void set_trim(bool on){
+    trim_states = on;
+  }
+
+  /** @brief Minimiert alle Automaten
+      @param dfas Die Automaten
+  */
+  void operator()(const std::vector<DFA*>& dfas){
+    auto start = std::chrono::steady_clock::now();
+    std::vector<DFA*> big;
+    std::vector<DFA*> jobs;
+    for(auto it = dfas.begin();it!=dfas.end();++it){
+      if((*it)->number_of_states() < threshold) jobs.push_back(*it);
+      else big.push_back(*it);
+    }
+    small = jobs.size();
+    large = big.size();
+
+    //Mehrere Arbeitsstränge je Thread, damit gestohlen werden kann
+    unsigned chunks = std::min<std::size_t>(Parallel::threads() * 4,jobs.size());
+    while(workers.size() < chunks) workers.push_back(std::unique_ptr<Hopcroft>(new Hopcroft(engine)));
+    std::atomic<std::size_t> next(0);
+    Parallel::parallel_for(0,chunks,[&](int c){
+      Parallel::SerialScope serial;
+      Hopcroft& minimize = prepare(*workers[c]);
+      for(std::size_t i = next++;i<jobs.size();i = next++) minimize(*jobs[i]);
+    },1);
+
+    if(!big.empty()){
+      if(workers.empty()) workers.push_back(std::unique_ptr<Hopcroft>(new Hopcroft(engine)));
+      Hopcroft& minimize = prepare(*workers[0]);
+      for(auto it = big.begin();it!=big.end();++it) minimize(**it);
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  /** @brief Minimiert alle Automaten
+      @param dfas Die Automaten
+  */
+  void operator()(std::vector<DFA>& dfas){
+    std::vector<DFA*> pointers;
+    pointers.reserve(dfas.size());
+    for(auto it = dfas.begin();it!=dfas.end();++it) pointers.push_back(&*it);
+    (*this)(pointers);
+  }
+
+  ///@brief Die Anzahl der Automaten unter der Schwelle beim letzten Aufruf
+  std::size_t small_jobs() const{
+    return small;
+  }
+
+  ///@brief Die Anzahl der Automaten ab der Schwelle beim letzten Aufruf
+  std::size_t large_jobs() const{
+    return large;
+  }
+
+  ///@brief Die Dauer des letzten Aufrufs in Sekunden
+  double duration() const{
+    return seconds;
+  }
+
+  private:
+
+  //Überträgt die Einstellungen auf die Instanz eines Arbeiters
+  Hopcroft& prepare(Hopcroft& minimize) const{
+    minimize.set_engine(engine);
+    minimize.set_symbol_classes(merge_symbols);
+    minimize.set_trim(trim_states);
+    return minimize;
+  }
+
+  Hopcroft::Engine engine; ///< Das Verfahren zur Verfeinerung
+  unsigned threshold; ///< Ab dieser Anzahl an Zuständen wird ein Automat für sich parallel minimiert
+  bool merge_symbols; ///< true wenn gleichwertige Symbole zusammengefasst werden
+  bool trim_states; ///< true wenn unerreichbare und tote Zustände vorher entfernt werden
+  std::vector<std::unique_ptr<Hopcroft> > workers; ///< Eine Hopcroft-Instanz je Arbeitsstrang, bleibt zwischen Aufrufen erhalten
+  std::size_t small; ///< Die Anzahl der Automaten unter der Schwelle
+  std::size_t large; ///< Die Anzahl der Automaten ab der Schwelle
+  double seconds; ///< Die Dauer des letzten Aufrufs
+
+};
+
+#endif
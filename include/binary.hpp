@@ -0,0 +1,318 @@
+////////////////////////////////////////////////////////////////////////////////
+// binary.hpp
+// Klasse für das Hopcroft Projekt
+// Binäres Dateiformat für Automaten, direkt über mmap abfragbar
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __BINARY_HPP__
+#define __BINARY_HPP__
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include "DFA.hpp"
+#include "mapped_file.hpp"
+
+/** @brief Das binäre Dateiformat
+
+    Alle Abschnitte sind auf 4 Bytes ausgerichtet und liegen so in der Datei,
+    wie sie im Speicher gebraucht werden (CSR), damit eine eingeblendete Datei
+    ohne Deserialisierung abgefragt werden kann:
+
+    - Header (64 Bytes, siehe Header)
+    - uint32 offsets[states+1]: Anfang der Zeile jedes Zustands
+    - uint32 targets[transitions]: Zielzustände, zeilenweise
+    - uint8 symbols[transitions]: Symbole, zeilenweise sortiert (auf 4 aufgefüllt)
+    - uint32 finals[(states+31)/32]: Bitvektor der Endzustände
+    - uint8 alphabet[alphabet_size]: Symbole in Indexreihenfolge (auf 4 aufgefüllt)
+
+    Die Prüfsumme (FNV-1a, 64 Bit) deckt alles hinter dem Header ab.
+    Zahlen stehen in der Bytereihenfolge des schreibenden Rechners; byte_order
+    erkennt Dateien mit fremder Bytereihenfolge.
+*/
+class BinaryFormat{
+
+  public:
+
+  static constexpr std::uint32_t VERSION = 1; ///< Die aktuelle Version des Formats
+
+  ///	@brief Der Kopf einer Datei
+  struct Header{
+    char magic[8]; ///< "HOPCDFA" mit abschließender Null
+    std::uint32_t byte_order; ///< 0x01020304 in der Bytereihenfolge des Schreibers
+    std::uint32_t version; ///< Die Version des Formats
+    std::uint32_t header_size; ///< Die Größe des Headers in Bytes
+    std::uint32_t state_count; ///< Die Anzahl der Zustände
+    std::uint32_t transition_count; ///< Die Anzahl der Übergänge
+    std::uint32_t start_state; ///< Der Startzustand
+    std::uint32_t alphabet_size; ///< Die Anzahl der Alphabetsymbole
+    std::uint32_t reserved; ///< Auffüllung, immer 0
+    std::uint64_t file_size; ///< Die Größe der ganzen Datei
+    std::uint64_t checksum; ///< FNV-1a über alles hinter dem Header
+    char padding[8]; ///< Auffüllung auf 64 Bytes
+  };
+
+  /** @brief Schreibt einen Automaten im Binärformat
+      @param dfa Der Automat
+      @param filename Der Name der Datei
+      @return false wenn die Datei nicht geschrieben werden konnte
+  */
+  static bool save(const DFA& dfa, const std::string& filename){
+    std::vector<char> body;
+    unsigned n = dfa.state_count;
+    //Offsets und Ziele
+    std::vector<std::uint32_t> offsets(n+1,0);
+    std::vector<std::uint32_t> targets;
+    std::string symbols;
+    targets.reserve(dfa.transitions.edges());
+    for(unsigned i = 0;i!=n;++i){
+      offsets[i] = targets.size();
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        targets.push_back(dfa.transitions.target(j));
+        symbols += dfa.transitions.symbol(j);
+      }
+    }
+    offsets[n] = targets.size();
+    std::vector<std::uint32_t> finals((n+31)/32,0);
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it){
+      finals[*it/32] |= std::uint32_t(1) << (*it%32);
+    }
+    std::string alphabet;
+    for(unsigned i = 0;i!=dfa.alphabet.size();++i) alphabet += dfa.alphabet.symbol(i);
+
+    append(body,offsets.data(),offsets.size()*4);
+    append(body,targets.data(),targets.size()*4);
+    append(body,symbols.data(),symbols.size());
+    append(body,finals.data(),finals.size()*4);
+    append(body,alphabet.data(),alphabet.size());
+
+    Header h;
+    std::memset(&h,0,sizeof(h));
+    std::memcpy(h.magic,"HOPCDFA",8);
+    h.byte_order = 0x01020304;
+    h.version = VERSION;
+    h.header_size = sizeof(Header);
+    h.state_count = n;
+    h.transition_count = targets.size();
+    h.start_state = dfa.start_state;
+    h.alphabet_size = alphabet.size();
+    h.file_size = sizeof(Header) + body.size();
+    h.checksum = checksum(body.data(),body.size());
+
+    std::ofstream out(filename.c_str(),std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&h),sizeof(h));
+    out.write(body.data(),body.size());
+    return out.good();
+  }
+
+  /** @brief Prüft den Header einer eingeblendeten Datei
+      @param data Der Anfang der Datei
+      @param size Die Größe der Datei
+      @param verify true wenn zusätzlich die Prüfsumme und alle Zeilen geprüft werden sollen (liest die ganze Datei)
+      @return eine Fehlermeldung oder einen leeren String
+  */
+  static std::string check(const char* data, std::size_t size, bool verify){
+    if(size < sizeof(Header)) return "file is too small";
+    const Header* h = reinterpret_cast<const Header*>(data);
+    if(std::memcmp(h->magic,"HOPCDFA",8) != 0) return "not a binary automaton";
+    if(h->byte_order != 0x01020304) return "byte order does not match";
+    if(h->version > VERSION) return "unsupported version";
+    if(h->header_size != sizeof(Header) || h->file_size != size) return "file is truncated";
+    std::uint64_t expected = sizeof(Header)
+                           + 4 * (std::uint64_t(h->state_count) + 1)
+                           + 4 * std::uint64_t(h->transition_count)
+                           + padded(h->transition_count)
+                           + 4 * ((std::uint64_t(h->state_count) + 31) / 32)
+                           + padded(h->alphabet_size);
+    if(expected != size) return "section sizes do not match";
+    //Prüfungen in konstanter Zeit auch ohne verify, sonst läse schon die erste Abfrage außerhalb der Abschnitte
+    if(h->state_count == 0) return "automaton has no states";
+    if(h->start_state >= h->state_count) return "start state out of range";
+    const std::uint32_t* offsets = reinterpret_cast<const std::uint32_t*>(data + sizeof(Header));
+    const std::uint32_t* targets = offsets + h->state_count + 1;
+    if(offsets[0] != 0 || offsets[h->state_count] != h->transition_count) return "corrupt offsets";
+    if(!verify) return "";
+    if(checksum(data + sizeof(Header),size - sizeof(Header)) != h->checksum) return "checksum mismatch";
+    //Strukturelle Prüfung aller Zeilen, damit Abfragen nie außerhalb der Abschnitte lesen
+    const unsigned char* symbols = reinterpret_cast<const unsigned char*>(targets + h->transition_count);
+    for(std::uint32_t i = 0;i!=h->state_count;++i){
+      if(offsets[i] > offsets[i+1]) return "corrupt offsets";
+      //MappedDFA::find verlässt sich auf streng aufsteigende Symbole je Zeile
+      for(std::uint32_t j = offsets[i];j+1<offsets[i+1];++j){
+        if(symbols[j] >= symbols[j+1]) return "row symbols not sorted";
+      }
+    }
+    for(std::uint32_t j = 0;j!=h->transition_count;++j){
+      if(targets[j] >= h->state_count) return "target out of range";
+    }
+    return "";
+  }
+
+  /** @brief Lädt einen Automaten aus dem Binärformat in einen (frischen) DFA
+      @param dfa Der Zielautomat, frisch mit DFA() erzeugt
+      @param filename Der Name der Datei
+      @return false wenn die Datei nicht gelesen werden konnte oder fehlerhaft ist
+  */
+  static bool load(DFA& dfa, const std::string& filename){
+    MappedFile file;
+    if(!file.open(filename)) return false;
+    std::string error = check(file.data(),file.size(),true);
+    if(!error.empty()){
+      std::cerr << "Error: " << filename << ": " << error << "\n";
+      return false;
+    }
+    const Header* h = reinterpret_cast<const Header*>(file.data());
+    const std::uint32_t* offsets = reinterpret_cast<const std::uint32_t*>(file.data() + sizeof(Header));
+    const std::uint32_t* targets = offsets + h->state_count + 1;
+    const char* symbols = reinterpret_cast<const char*>(targets + h->transition_count);
+    const std::uint32_t* finals = reinterpret_cast<const std::uint32_t*>(symbols + padded(h->transition_count));
+    const char* alphabet = reinterpret_cast<const char*>(finals + (h->state_count + 31) / 32);
+
+    for(unsigned i = 0;i!=h->alphabet_size;++i){
+      char c = alphabet[i];
+      dfa.alphabet.add(c);
+    }
+    std::vector<Transitions::Arc> arcs(h->transition_count);
+    for(unsigned i = 0;i!=h->state_count;++i){
+      for(unsigned j = offsets[i];j!=offsets[i+1];++j){
+        arcs[j].source = i;
+        arcs[j].target = targets[j];
+        arcs[j].symbol = symbols[j];
+      }
+    }
+    dfa.transitions.assign(h->state_count,arcs);
+    dfa.state_count = h->state_count;
+    dfa.transition_count = h->transition_count;
+    dfa.start_state = h->start_state;
+    dfa.signatures.assign(h->state_count);
+    dfa.final_states.clear();
+    for(unsigned i = 0;i!=h->state_count;++i){
+      for(unsigned j = offsets[i];j!=offsets[i+1];++j) dfa.signatures.add(i,dfa.alphabet[symbols[j]]);
+      if(finals[i/32] >> (i%32) & 1){
+        dfa.final_states.insert(i);
+        dfa.signatures.set_final(i);
+      }
+    }
+    return true;
+  }
+
+  ///@brief Die Länge eines Byte-Abschnitts einschließlich Auffüllung auf 4 Bytes
+  static std::uint64_t padded(std::uint64_t n){
+    return (n + 3) & ~std::uint64_t(3);
+  }
+
+  /** @brief FNV-1a (64 Bit)
+      @param h optional: die Prüfsumme der vorangehenden Bytes, um abschnittsweise weiterzurechnen
+  */
+  static std::uint64_t checksum(const char* data, std::size_t size, std::uint64_t h = 0xcbf29ce484222325ULL){
+    for(std::size_t i = 0;i!=size;++i){
+      h = (h ^ (unsigned char)data[i]) * 0x100000001b3ULL;
+    }
+    return h;
+  }
+
+  private:
+
+  //Hängt Bytes an und füllt auf ein Vielfaches von 4 auf
+  static void append(std::vector<char>& body, const void* data, std::size_t size){
+    const char* p = static_cast<const char*>(data);
+    body.insert(body.end(),p,p+size);
+    while(body.size() % 4) body.push_back(0);
+  }
+
+};
+
+/** @brief Ein eingeblendeter Automat im Binärformat, der ohne Deserialisierung abgefragt wird
+
+    Die Abschnitte der Datei werden direkt als Arrays verwendet. Mehrere Prozesse,
+    die dieselbe Datei einblenden, teilen sich die Speicherseiten.
+*/
+class MappedDFA{
+
+  public:
+
+  ///@brief Der Konstruktor der Klasse
+  MappedDFA(){
+    header = nullptr;
+  }
+
+  /** @brief Blendet eine Datei ein
+      @param filename Der Name der Datei
+      @param verify optional: true wenn die Prüfsumme berechnet werden soll (liest die ganze Datei)
+      @return false wenn die Datei nicht geöffnet werden konnte oder fehlerhaft ist
+  */
+  bool open(const std::string& filename, bool verify = true){
+    header = nullptr;
+    if(!file.open(filename)) return false;
+    std::string error = BinaryFormat::check(file.data(),file.size(),verify);
+    if(!error.empty()){
+      std::cerr << "Error: " << filename << ": " << error << "\n";
+      file.close();
+      return false;
+    }
+    header = reinterpret_cast<const BinaryFormat::Header*>(file.data());
+    offsets = reinterpret_cast<const std::uint32_t*>(file.data() + sizeof(BinaryFormat::Header));
+    targets = offsets + header->state_count + 1;
+    symbols = reinterpret_cast<const char*>(targets + header->transition_count);
+    finals = reinterpret_cast<const std::uint32_t*>(symbols + BinaryFormat::padded(header->transition_count));
+    return true;
+  }
+
+  ///@brief Die Anzahl der Zustände
+  unsigned state_count() const{
+    return header->state_count;
+  }
+
+  ///@brief Die Anzahl der Übergänge
+  unsigned transition_count() const{
+    return header->transition_count;
+  }
+
+  ///@brief Der Startzustand
+  unsigned start_state() const{
+    return header->start_state;
+  }
+
+  ///@brief true wenn der Zustand ein Endzustand ist
+  bool is_final(unsigned state) const{
+    return finals[state/32] >> (state%32) & 1;
+  }
+
+  /** @brief Sucht den Übergang eines Zustands mit einem Symbol
+      @return der Zielzustand oder Transitions::NONE
+  */
+  unsigned find(unsigned state, char c) const{
+    //Die Zeilen sind nach Symbolen (als unsigned char) sortiert, die Suche endet beim ersten größeren
+    for(unsigned j = offsets[state];j!=offsets[state+1];++j){
+      if((unsigned char)symbols[j] < (unsigned char)c) continue;
+      return symbols[j] == c ? targets[j] : Transitions::NONE;
+    }
+    return Transitions::NONE;
+  }
+
+  /** @brief Prüft ob der Automat ein Wort akzeptiert
+      @param word Das Wort
+  */
+  bool accepts(const std::string& word) const{
+    unsigned state = header->start_state;
+    for(std::size_t i = 0;i!=word.size();++i){
+      state = find(state,word[i]);
+      if(state == Transitions::NONE) return false;
+    }
+    return is_final(state);
+  }
+
+  private:
+
+  MappedFile file; ///< Die eingeblendete Datei
+  const BinaryFormat::Header* header; ///< Der Header
+  const std::uint32_t* offsets; ///< Die Zeilenanfänge
+  const std::uint32_t* targets; ///< Die Zielzustände
+  const char* symbols; ///< Die Symbole
+  const std::uint32_t* finals; ///< Der Bitvektor der Endzustände
+
+};
+
+#endif
@@ -0,0 +1,453 @@
+////////////////////////////////////////////////////////////////////////////////
+// daciuk.hpp
+// Klasse für das Hopcroft Projekt
+// Inkrementeller Aufbau minimaler azyklischer Automaten
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DACIUK_HPP__
+#define __DACIUK_HPP__
+
+#include <vector>
+#include <string>
+#include <unordered_set>
+#include "DFA.hpp"
+
+/** @brief Klasse zum inkrementellen Aufbau minimaler azyklischer Automaten
+           nach Daciuk, Mihov, Watson und Watson (2000)
+
+    Statt erst einen vollständigen Trie aufzubauen und ihn anschließend mit Hopcroft
+    zu minimieren, wird der Automat schon während des Einfügens minimal gehalten.
+    Ein Register enthält je Äquivalenzklasse genau einen Zustand; fertige Zustände
+    werden gegen das Register geprüft und gegebenenfalls durch ihren Vertreter ersetzt.
+    Freigewordene Zustände werden wiederverwendet, so dass der Speicherbedarf nahe
+    an dem des minimalen Automaten bleibt.
+
+    Im sortierten Modus müssen die Wörter in Bytereihenfolge eintreffen, dann ist immer
+    nur der Pfad des zuletzt eingefügten Wortes unregistriert. Im unsortierten Modus wird
+    jedes Wort einzeln eingefügt; Konfluenzzustände auf dem Pfad werden dabei geklont.
+    Trifft im sortierten Modus ein Wort außer der Reihe ein, wird auf den unsortierten
+    Modus umgeschaltet.
+
+    Ein bereits minimaler azyklischer Automat (z.B. nach Hopcroft) kann nachträglich
+    geändert werden: Das Register und die Eingangsgrade werden einmal aus dem Automaten
+    aufgebaut, danach kosten add() und remove() nur Zeit proportional zur Wortlänge, da
+    nur die Zustände auf dem Pfad des Wortes geklont und neu registriert werden.
+
+    Endzustände und Übergangszahl des DFA sind nach jedem add() und remove() aktuell,
+    der Automat kann also jederzeit abgefragt werden (im sortierten Modus erst nach
+    finish(), da der letzte Pfad bis dahin nicht minimiert ist). Freigegebene Zustände
+    bleiben als isolierte Zustände ohne Übergänge in der Zustandszahl enthalten, bis
+    compact() sie entfernt. Solange das Objekt benutzt wird, darf der DFA nur über
+    dieses geändert werden.
+*/
+class Daciuk{
+
+  public:
+
+  /** @brief Der Konstruktor der Klasse
+      @param d Der aufzubauende Automat. Er muss leer sein, d.h. frisch mit DFA() erzeugt,
+               oder minimal und azyklisch, dann werden Wörter eingefügt und entfernt.
+      @param s true wenn die Wörter sortiert eintreffen. Bei einem nicht leeren Automaten
+               wird immer unsortiert eingefügt.
+  */
+  Daciuk(DFA& d, bool s = true)
+    : dfa(d), sorted(s), reg(1024,StateHash(this),StateEqual(this))
+  {
+    cyclic = false;
+    stale = dfa.state_count > 1 || dfa.transitions.degree(dfa.start_state) || !dfa.final_states.empty();
+    if(stale) sorted = false;
+    finals.assign(dfa.state_count,false);
+    in_degree.assign(dfa.state_count,0);
+    dead.assign(dfa.state_count,false);
+  }
+
+  /** @brief Fügt dem Automaten ein Wort hinzu
+      @param word Das Wort
+  */
+  void add(const std::string& word){
+    if(stale) attach();
+    if(cyclic) return;
+    if(sorted){
+      if(word < previous){
+        std::cerr << "Warning: input is not sorted, switching to unsorted insertion.\n";
+        if(dfa.transitions.degree(dfa.start_state)) replace_or_register(dfa.start_state);
+        sorted = false;
+      }
+      else{
+        add_sorted(word);
+        previous = word;
+        return;
+      }
+    }
+    add_unsorted(word);
+  }
+
+  /** @brief Entfernt ein Wort aus dem Automaten, der Automat bleibt minimal
+      @param word Das Wort
+      @return false wenn das Wort nicht enthalten war
+  */
+  bool remove(const std::string& word){
+    if(stale) attach();
+    if(cyclic) return false;
+    if(sorted){
+      //Der offene Pfad des sortierten Modus wird vorher registriert
+      if(dfa.transitions.degree(dfa.start_state)) replace_or_register(dfa.start_state);
+      sorted = false;
+    }
+    path.clear();
+    path.push_back(dfa.start_state);
+    for(unsigned i = 0;i!=word.size();++i){
+      unsigned next_state = dfa.transitions.find(path.back(),word[i]);
+      if(next_state==Transitions::NONE) return false;
+      path.push_back(next_state);
+    }
+    if(!finals[path.back()]) return false;
+
+    separate(word);
+    finals[path.back()] = false;
+    dfa.final_states.erase(path.back());
+    update_signature(path.back());
+    reregister(word);
+    return true;
+  }
+
+  /** @brief Schließt den Aufbau ab: Registriert den letzten Pfad des sortierten Modus,
+             danach ist der Automat minimal. Register und Eingangsgrade bleiben gültig,
+             weitere Aufrufe von add() und remove() fügen unsortiert ein.
+  */
+  void finish(){
+    if(stale || cyclic) return;
+    if(sorted && dfa.transitions.degree(dfa.start_state)) replace_or_register(dfa.start_state);
+    sorted = false;
+  }
+
+  /** @brief Schließt den Aufbau ab (siehe finish()) und nummeriert die Zustände lückenlos,
+             freigegebene Zustände verschwinden dabei. Kostet Zeit linear in der Größe des
+             Automaten; das Register wird mit den neuen Nummern neu aufgebaut.
+  */
+  void compact(){
+    finish();
+    if(stale || cyclic) return;
+    renumber();
+    reg.clear();
+    for(unsigned s = 0;s!=dfa.state_count;++s){
+      if(s != dfa.start_state) reg.insert(s);
+    }
+  }
+
+  ///@brief Die Anzahl freigegebener Zustände, die compact() entfernen würde
+  unsigned released() const{
+    return free_states.size();
+  }
+
+  ///@brief Die Anzahl der registrierten Zustände
+  unsigned registered() const{
+    return reg.size();
+  }
+
+  private:
+
+  ///	@brief Hashfunktion für das Register: Endzustandsmarkierung und Übergänge
+  struct StateHash{
+    StateHash(Daciuk* d){
+      dac = d;
+    }
+    std::size_t operator()(unsigned s) const{
+      const Transitions& t = dac->dfa.transitions;
+      std::size_t h = dac->finals[s] ? 0x9e3779b97f4a7c15ULL : 0;
+      for(unsigned j = t.begin(s);j!=t.end(s);++j){
+        h = (h ^ (unsigned char)t.symbol(j)) * 0x100000001b3ULL;
+        h = (h ^ t.target(j)) * 0x100000001b3ULL;
+      }
+      return h ^ (h >> 29);
+    }
+    Daciuk* dac;
+  };
+
+  ///	@brief Gleichheit für das Register: gleiche Endzustandsmarkierung und gleiche Übergänge
+  struct StateEqual{
+    StateEqual(Daciuk* d){
+      dac = d;
+    }
+    bool operator()(unsigned one, unsigned two) const{
+      const Transitions& t = dac->dfa.transitions;
+      if(dac->finals[one] != dac->finals[two]) return false;
+      if(t.degree(one) != t.degree(two)) return false;
+      for(unsigned i = t.begin(one), j = t.begin(two);i!=t.end(one);++i,++j){
+        if(t.symbol(i) != t.symbol(j) || t.target(i) != t.target(j)) return false;
+      }
+      return true;
+    }
+    Daciuk* dac;
+  };
+
+  ///	@brief Einfügen bei sortierter Eingabe
+  void add_sorted(const std::string& word){
+    //Gemeinsames Präfix mit dem vorherigen Wort: es liegt vollständig auf dem
+    //noch unregistrierten Pfad, da alle anderen Äste kleiner sind
+    unsigned current_state = dfa.start_state;
+    unsigned i = 0;
+    for(;i!=word.size();++i){
+      unsigned next_state = dfa.transitions.find(current_state,word[i]);
+      if(next_state==Transitions::NONE) break;
+      current_state = next_state;
+    }
+    //Der Rest des vorherigen Wortes wird minimiert
+    if(dfa.transitions.degree(current_state)) replace_or_register(current_state);
+    //Anhängen des Suffixes
+    for(;i!=word.size();++i){
+      current_state = append(current_state,word[i]);
+    }
+    make_final(current_state);
+  }
+
+  ///	@brief Einfügen bei unsortierter Eingabe
+  void add_unsorted(const std::string& word){
+    //Der Pfad des Präfixes, das bereits im Automaten ist
+    path.clear();
+    path.push_back(dfa.start_state);
+    unsigned i = 0;
+    for(;i!=word.size();++i){
+      unsigned next_state = dfa.transitions.find(path.back(),word[i]);
+      if(next_state==Transitions::NONE) break;
+      path.push_back(next_state);
+    }
+    //Das Wort ist bereits enthalten
+    if(i==word.size() && finals[path.back()]) return;
+
+    separate(word);
+    //Anhängen des Suffixes
+    for(;i!=word.size();++i){
+      path.push_back(append(path.back(),word[i]));
+    }
+    make_final(path.back());
+    reregister(word);
+  }
+
+  ///	@brief Macht den Pfad eines Wortes exklusiv, damit er geändert werden kann
+  void separate(const std::string& word){
+    //Ab dem ersten Konfluenzzustand wird geklont. Die Zustände davor ändern sich
+    //und werden aus dem Register genommen, die Originale der Klone bleiben unverändert.
+    unsigned k = 1;
+    while(k!=path.size() && in_degree[path[k]]<2) ++k;
+    for(unsigned j = 1;j!=k;++j) unregister(path[j]);
+    for(;k!=path.size();++k){
+      unsigned c = clone(path[k]);
+      dfa.transitions.set(path[k-1],word[k-1],c);
+      --in_degree[path[k]];
+      ++in_degree[c];
+      path[k] = c;
+    }
+  }
+
+  ///	@brief Prüft den geänderten Pfad von hinten nach vorne gegen das Register
+  void reregister(const std::string& word){
+    for(unsigned k = path.size()-1;k!=0;--k){
+      if(!finals[path[k]] && !dfa.transitions.degree(path[k])){
+        //Nach dem Entfernen eines Wortes führt der Zustand zu keinem Endzustand mehr
+        dfa.transitions.erase(path[k-1],word[k-1]);
+        --dfa.transition_count;
+        update_signature(path[k-1]);
+        release(path[k]);
+        continue;
+      }
+      auto it = reg.find(path[k]);
+      if(it != reg.end()){
+        dfa.transitions.set(path[k-1],word[k-1],*it);
+        ++in_degree[*it];
+        release(path[k]);
+      }
+      else{
+        reg.insert(path[k]);
+      }
+    }
+  }
+
+  /// @brief Baut Endzustandsmarkierungen, Eingangsgrade und Register aus dem Automaten auf
+  void attach(){
+    stale = false;
+    unsigned n = dfa.state_count;
+    finals.assign(n,false);
+    in_degree.assign(n,0);
+    dead.assign(n,false);
+    free_states.clear();
+    reg.clear();
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) finals[*it] = true;
+    for(unsigned s = 0;s!=n;++s){
+      for(unsigned j = dfa.transitions.begin(s);j!=dfa.transitions.end(s);++j) ++in_degree[dfa.transitions.target(j)];
+    }
+    //Zyklensuche durch topologisches Sortieren (Kahn), das Register setzt Azyklizität voraus
+    std::vector<unsigned> degree(in_degree), queue;
+    for(unsigned s = 0;s!=n;++s){
+      if(!degree[s]) queue.push_back(s);
+    }
+    for(std::size_t q = 0;q!=queue.size();++q){
+      for(unsigned j = dfa.transitions.begin(queue[q]);j!=dfa.transitions.end(queue[q]);++j){
+        if(!--degree[dfa.transitions.target(j)]) queue.push_back(dfa.transitions.target(j));
+      }
+    }
+    if(queue.size() != n){
+      std::cerr << "Error: incremental updates need an acyclic automaton.\n";
+      cyclic = true;
+      return;
+    }
+    //Der Startzustand wird bei jedem Wort geändert und daher nie registriert
+    std::size_t duplicates = 0;
+    for(unsigned s = 0;s!=n;++s){
+      if(s != dfa.start_state && !reg.insert(s).second) ++duplicates;
+    }
+    if(duplicates) std::cerr << "Warning: the automaton is not minimal, " << duplicates << " equivalent states stay separate.\n";
+  }
+
+  /// @brief Ersetzt das letzte Kind eines Zustands durch einen äquivalenten registrierten Zustand oder registriert es
+  void replace_or_register(unsigned state){
+    unsigned pos = dfa.transitions.end(state)-1;
+    unsigned child = dfa.transitions.target(pos);
+    if(dfa.transitions.degree(child)) replace_or_register(child);
+    auto it = reg.find(child);
+    if(it != reg.end()){
+      dfa.transitions.set(state,dfa.transitions.symbol(pos),*it);
+      ++in_degree[*it];
+      release(child);
+    }
+    else{
+      reg.insert(child);
+    }
+  }
+
+  /// @brief Nimmt einen Zustand aus dem Register, falls er dort eingetragen ist
+  void unregister(unsigned state){
+    auto it = reg.find(state);
+    if(it != reg.end() && *it == state) reg.erase(it);
+  }
+
+  /// @brief Hängt an einen Zustand einen Übergang zu einem neuen Zustand an
+  unsigned append(unsigned state, char c){
+    unsigned next_state = create();
+    dfa.alphabet.add(c);
+    dfa.transitions.set(state,c,next_state);
+    dfa.signatures.add(state,dfa.alphabet[c]);
+    ++dfa.transition_count;
+    ++in_degree[next_state];
+    return next_state;
+  }
+
+  /// @brief Setzt die Signatur eines Zustands aus seinen Übergängen neu
+  void update_signature(unsigned state){
+    dfa.signatures.reset(state);
+    for(unsigned j = dfa.transitions.begin(state);j!=dfa.transitions.end(state);++j){
+      dfa.signatures.add(state,dfa.alphabet[dfa.transitions.symbol(j)]);
+    }
+    if(finals[state]) dfa.signatures.set_final(state);
+  }
+
+  /// @brief Markiert einen Zustand als Endzustand
+  void make_final(unsigned state){
+    finals[state] = true;
+    dfa.final_states.insert(state);
+    dfa.signatures.set_final(state);
+  }
+
+  /// @brief Erzeugt einen neuen Zustand ohne Übergänge, bevorzugt aus freigegebenen Zuständen
+  unsigned create(){
+    if(!free_states.empty()){
+      unsigned state = free_states.back();
+      free_states.pop_back();
+      dead[state] = false;
+      return state;
+    }
+    dfa.transitions.push_back();
+    dfa.signatures.push_back();
+    finals.push_back(false);
+    in_degree.push_back(0);
+    dead.push_back(false);
+    return dfa.state_count++;
+  }
+
+  /// @brief Erzeugt eine Kopie eines Zustands mit den gleichen Übergängen
+  unsigned clone(unsigned state){
+    unsigned c = create();
+    //Die Zeile wird zuerst kopiert, da set beim Wachsen die Zeilen verschieben kann
+    row.clear();
+    for(unsigned j = dfa.transitions.begin(state);j!=dfa.transitions.end(state);++j){
+      row.push_back(std::make_pair(dfa.transitions.symbol(j),dfa.transitions.target(j)));
+    }
+    for(auto it = row.begin();it!=row.end();++it){
+      dfa.transitions.set(c,it->first,it->second);
+      ++in_degree[it->second];
+    }
+    dfa.transition_count += row.size();
+    dfa.signatures.copy(c,state);
+    finals[c] = finals[state];
+    if(finals[c]) dfa.final_states.insert(c);
+    return c;
+  }
+
+  /// @brief Gibt einen Zustand frei, der durch einen äquivalenten ersetzt wurde
+  void release(unsigned state){
+    for(unsigned j = dfa.transitions.begin(state);j!=dfa.transitions.end(state);++j){
+      --in_degree[dfa.transitions.target(j)];
+    }
+    dfa.transition_count -= dfa.transitions.degree(state);
+    dfa.transitions.reset(state);
+    dfa.signatures.reset(state);
+    finals[state] = false;
+    dfa.final_states.erase(state);
+    in_degree[state] = 0;
+    dead[state] = true;
+    free_states.push_back(state);
+  }
+
+  /// @brief Nummeriert die lebenden Zustände lückenlos und überträgt das Ergebnis in den DFA
+  void renumber(){
+    std::vector<unsigned> number(dfa.state_count,Transitions::NONE);
+    unsigned new_state_count = 0;
+    for(unsigned i = 0;i!=dfa.state_count;++i){
+      if(!dead[i]) number[i] = new_state_count++;
+    }
+    Transitions new_transitions;
+    new_transitions.reserve(new_state_count,dfa.transitions.edges());
+    std::vector<unsigned> live;
+    live.reserve(new_state_count);
+    //Ein frisches Set, clear() behielte die Buckets der während des Aufbaus eingetragenen Zustände
+    std::unordered_set<unsigned>().swap(dfa.final_states);
+    for(unsigned i = 0;i!=dfa.state_count;++i){
+      if(dead[i]) continue;
+      new_transitions.push_back();
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        new_transitions.set(number[i],dfa.transitions.symbol(j),number[dfa.transitions.target(j)]);
+      }
+      live.push_back(i);
+      if(finals[i]) dfa.final_states.insert(number[i]);
+    }
+    dfa.transition_count = new_transitions.edges();
+    dfa.transitions = std::move(new_transitions);
+    dfa.signatures = dfa.signatures.select(live);
+    dfa.start_state = number[dfa.start_state];
+    dfa.state_count = new_state_count;
+    free_states.clear();
+    finals.assign(new_state_count,false);
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) finals[*it] = true;
+    std::vector<unsigned> new_in_degree(new_state_count);
+    for(unsigned i = 0;i!=new_state_count;++i) new_in_degree[i] = in_degree[live[i]];
+    in_degree.swap(new_in_degree);
+    dead.assign(new_state_count,false);
+  }
+
+  DFA& dfa; ///< Der aufzubauende Automat
+  bool sorted; ///< true solange die Wörter sortiert eintreffen
+  bool stale; ///< true wenn das Register vor der nächsten Änderung aus dem Automaten aufgebaut werden muss
+  bool cyclic; ///< true wenn der Automat Zyklen hat und nicht geändert werden kann
+  std::string previous; ///< Das zuletzt eingefügte Wort im sortierten Modus
+
+  std::unordered_set<unsigned,StateHash,StateEqual> reg; ///< Das Register der minimierten Zustände
+  std::vector<bool> finals; ///< Endzustandsmarkierungen aller Zustände
+  std::vector<unsigned> in_degree; ///< Die Anzahl der eingehenden Übergänge je Zustand
+  std::vector<bool> dead; ///< Markiert freigegebene Zustände
+  std::vector<unsigned> free_states; ///< Freigegebene Zustände zur Wiederverwendung
+  std::vector<unsigned> path; ///< Der Pfad des aktuellen Wortes im unsortierten Modus
+  std::vector<std::pair<char,unsigned> > row; ///< Die Übergänge des zuletzt geklonten Zustands
+
+};
+
+#endif
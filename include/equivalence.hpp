@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+// equivalence.hpp
+// Klasse für das Hopcroft Projekt
+// Vergleich der Sprachen zweier Automaten ohne Minimierung
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __EQUIVALENCE_HPP__
+#define __EQUIVALENCE_HPP__
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include "DFA.hpp"
+
+/** @brief Prüft, ob zwei Automaten dieselbe Sprache erkennen (Hopcroft und Karp)
+
+    Die Zustände beider Automaten werden in einer gemeinsamen Union-Find-Struktur
+    verwaltet. Ausgehend vom Paar der Startzustände wird jedes Paar, dessen
+    Zustände noch in verschiedenen Mengen liegen, vereinigt und über alle Symbole
+    beider Zeilen weiterverfolgt. Fehlende Übergänge führen in eine gemeinsame
+    implizite Senke, die Automaten müssen also weder vollständig noch getrimmt
+    sein. Es werden höchstens so viele Paare verfolgt, wie beide Automaten
+    zusammen Zustände haben, die Laufzeit ist damit nahezu linear.
+    Unterscheidet ein Paar die Endzustände, bricht der Vergleich sofort ab; da
+    die Paare in Breitensuche abgearbeitet werden, ist das Gegenbeispiel ein
+    kürzestes unter den verfolgten Wörtern.
+*/
+class Equivalence{
+
+  public:
+
+  ///@brief Der Konstruktor der Klasse
+  Equivalence(){
+    first_accepts = false;
+    visited = 0;
+    seconds = 0;
+  }
+
+  /** @brief Vergleicht die Sprachen zweier Automaten
+      @param a Der erste Automat
+      @param b Der zweite Automat
+      @return true wenn beide dieselbe Sprache erkennen, sonst steht ein Gegenbeispiel bereit
+  */
+  bool operator()(const DFA& a, const DFA& b){
+    auto start = std::chrono::steady_clock::now();
+    unsigned n = a.state_count;
+    //Zustände von b folgen auf die von a, danach die Senke
+    sink = n + b.state_count;
+    parent.resize(sink + 1);
+    for(unsigned i = 0;i!=sink+1;++i) parent[i] = i;
+    size.assign(sink + 1,1);
+    pairs.clear();
+    word.clear();
+    first_accepts = false;
+
+    bool equal = true;
+    if(a.state_count && b.state_count) unite(a.start_state,n + b.start_state);
+    pairs.push_back(Pair{a.state_count ? a.start_state : sink,b.state_count ? n + b.start_state : sink,NONE,0});
+    for(std::size_t head = 0;head!=pairs.size() && equal;++head){
+      unsigned p = pairs[head].p, q = pairs[head].q;
+      bool fp = p != sink && a.final_states.count(p);
+      bool fq = q != sink && b.final_states.count(q - n);
+      if(fp != fq){
+        equal = false;
+        first_accepts = fp;
+        for(std::size_t k = head;pairs[k].from!=NONE;k = pairs[k].from) word.push_back(pairs[k].symbol);
+        std::reverse(word.begin(),word.end());
+        break;
+      }
+      //Beide Zeilen sind nach Symbolen (als unsigned char) sortiert
+      unsigned i = p == sink ? 0 : a.transitions.begin(p), ie = p == sink ? 0 : a.transitions.end(p);
+      unsigned j = q == sink ? 0 : b.transitions.begin(q - n), je = q == sink ? 0 : b.transitions.end(q - n);
+      while(i != ie || j != je){
+        unsigned ci = i != ie ? (unsigned char)a.transitions.symbol(i) : 256;
+        unsigned cj = j != je ? (unsigned char)b.transitions.symbol(j) : 256;
+        unsigned c = std::min(ci,cj);
+        unsigned s = ci == c ? a.transitions.target(i++) : sink;
+        unsigned t = cj == c ? n + b.transitions.target(j++) : sink;
+        if(unite(s,t)) pairs.push_back(Pair{s,t,(unsigned)head,(char)c});
+      }
+    }
+    visited = pairs.size();
+    std::vector<Pair>().swap(pairs);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return equal;
+  }
+
+  ///@brief Ein kürzestes gefundenes Wort, das genau einer der Automaten erkennt (nach false)
+  const std::string& counterexample() const{
+    return word;
+  }
+
+  ///@brief true wenn das Gegenbeispiel vom ersten Automaten erkannt wird, sonst vom zweiten
+  bool accepted_by_first() const{
+    return first_accepts;
+  }
+
+  ///@brief Die Anzahl der verfolgten Zustandspaare beim letzten Vergleich
+  std::size_t pairs_visited() const{
+    return visited;
+  }
+
+  ///@brief Die Dauer des letzten Vergleichs in Sekunden
+  double duration() const{
+    return seconds;
+  }
+
+  private:
+
+  static constexpr unsigned NONE = ~0u; ///< Kein Vorgänger (Paar der Startzustände)
+
+  ///	@brief Ein verfolgtes Zustandspaar mit dem Paar, über das es erreicht wurde
+  struct Pair{
+    unsigned p; ///< Der Zustand des ersten Automaten oder die Senke
+    unsigned q; ///< Der Zustand des zweiten Automaten (verschoben) oder die Senke
+    unsigned from; ///< Der Index des Vorgängerpaars oder NONE
+    char symbol; ///< Das Symbol vom Vorgängerpaar hierher
+  };
+
+  //Der Repräsentant einer Menge, mit Pfadhalbierung
+  unsigned find(unsigned x){
+    while(parent[x] != x){
+      parent[x] = parent[parent[x]];
+      x = parent[x];
+    }
+    return x;
+  }
+
+  //Vereinigt die Mengen zweier Zustände, false wenn sie schon dieselbe waren
+  bool unite(unsigned x, unsigned y){
+    x = find(x);
+    y = find(y);
+    if(x == y) return false;
+    if(size[x] < size[y]) std::swap(x,y);
+    parent[y] = x;
+    size[x] += size[y];
+    return true;
+  }
+
+  std::vector<unsigned> parent; ///< Die Union-Find-Struktur über die Zustände beider Automaten und die Senke
+  std::vector<unsigned> size; ///< Die Größe der Menge je Repräsentant
+  std::vector<Pair> pairs; ///< Die verfolgten Paare in Reihenfolge der Breitensuche
+  unsigned sink; ///< Die gemeinsame Senke für fehlende Übergänge
+  std::string word; ///< Das Gegenbeispiel
+  bool first_accepts; ///< true wenn das Gegenbeispiel vom ersten Automaten erkannt wird
+  std::size_t visited; ///< Die Anzahl der verfolgten Paare
+  double seconds; ///< Die Dauer des letzten Vergleichs
+
+};
+
+#endif
@@ -0,0 +1,781 @@
+////////////////////////////////////////////////////////////////////////////////
+// external.hpp
+// Klasse für das Hopcroft Projekt
+// Minimierung von Automaten, die nicht in den Hauptspeicher passen
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __EXTERNAL_HPP__
+#define __EXTERNAL_HPP__
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include "tfsm.hpp"
+#include "binary.hpp"
+#include "external_sort.hpp"
+
+/** @brief Minimierung außerhalb des Hauptspeichers (out of core)
+
+    Für Automaten, deren Übergänge nicht in den Speicher passen. Alle Zwischen-
+    ergebnisse liegen als Dateien im temporären Verzeichnis und werden nur
+    sequentiell gelesen; Sortierläufe und Hashtabellen bleiben im Budget.
+    Im Speicher liegt nie ein Array über alle Zustände.
+
+    Verfeinert wird nach Moore, je Runde:
+    - Die nach Ziel sortierten Übergänge werden mit der Blockdatei (der Block
+      jedes Zustands in Zustandsreihenfolge) zu (Quelle, Symbol, Block des Ziels)
+    - Diese Datensätze werden extern nach (Quelle, Symbol) sortiert
+    - Jeder Zustand erhält die Signatur (alter Block, Endzustand, (Symbol, Block des Ziels)*),
+      die über ihren Hash auf Eimer verteilt wird, deren Signaturen in das Budget passen
+    - Jeder Eimer wird mit einer Hashtabelle durchnummeriert: gleiche Signatur, gleicher Block
+    - Die Paare (Zustand, neuer Block) werden nach Zustand sortiert und bilden die neue Blockdatei
+    Ändert sich die Anzahl der Blöcke nicht mehr, ist die Partition stabil und
+    die erste Signatur jedes Blocks liefert seine Übergänge im minimalen Automaten.
+
+    Vor der Verfeinerung werden wie mit Trimmer unerreichbare und tote Zustände
+    entfernt (abschaltbar mit set_trim()). Auch das geschieht in Runden über die
+    Dateien: Je Runde liefern die nach Quelle (vorwärts) bzw. nach Ziel (rückwärts)
+    sortierten Übergänge die Nachfolger bzw. Vorgänger der zuletzt neu markierten
+    Zustände, bis keine neuen mehr hinzukommen; die Anzahl der Runden ist also
+    die Tiefe des Automaten. Die lebenden Zustände werden danach lückenlos neu
+    nummeriert.
+
+    Symbole aus mehreren Bytes werden nicht unterstützt, ihre Zwischenzustände
+    vergibt der TfsmReader im Speicher.
+*/
+class ExternalMinimizer{
+
+  public:
+
+  ///	@brief Das Format der Ausgabe
+  enum Format{
+    TFSM, ///< AT&T-Format, wie die Eingabe
+    BINARY ///< Das Binärformat von BinaryFormat
+  };
+
+  /** @brief Der Konstruktor der Klasse
+      @param budget optional: der höchstens belegte Speicher in Bytes. Default = 256 MB
+      @param directory optional: das Verzeichnis für temporäre Dateien. Default = "."
+  */
+  ExternalMinimizer(std::size_t budget = std::size_t(256) << 20, const std::string& directory = "."){
+    if(budget < (std::size_t(1) << 20)) budget = std::size_t(1) << 20;
+    this->budget = budget;
+    std::uint64_t id = std::chrono::steady_clock::now().time_since_epoch().count() ^ reinterpret_cast<std::uintptr_t>(this);
+    prefix = directory + "/hopcroft-" + std::to_string(id % 1000000007);
+    buckets = 0;
+    trim = true;
+    clear();
+  }
+
+  /** @brief Legt fest, ob unerreichbare und tote Zustände vor der Verfeinerung entfernt werden
+      @param t true (Default) zum Entfernen
+  */
+  void set_trim(bool t){
+    trim = t;
+  }
+
+  /** @brief Minimiert eine tfsm-Datei und schreibt den minimalen Automaten
+      @param input Die Eingabedatei im AT&T-Format
+      @param output Die Ausgabedatei
+      @param format optional: das Format der Ausgabe. Default = TFSM
+      @return false wenn eine Datei nicht gelesen oder geschrieben werden konnte
+  */
+  bool operator()(const std::string& input, const std::string& output, Format format = TFSM){
+    return format == TFSM ? (*this)(input,output,"") : (*this)(input,"",output);
+  }
+
+  /** @brief Minimiert eine tfsm-Datei einmal und schreibt den minimalen Automaten in beiden Formaten
+      @param input Die Eingabedatei im AT&T-Format
+      @param tfsm Die Ausgabedatei im AT&T-Format, leer für keine
+      @param binary Die Ausgabedatei im Binärformat, leer für keine
+      @return false wenn eine Datei nicht gelesen oder geschrieben werden konnte
+  */
+  bool operator()(const std::string& input, const std::string& tfsm, const std::string& binary){
+    auto begin = std::chrono::steady_clock::now();
+    clear();
+    if(!std::ofstream(file("arcs").c_str(),std::ios::binary)){
+      std::cerr << "Error: cannot create temporary files " << prefix << ".*\n";
+      return false;
+    }
+    bool ok = read(input);
+    if(!ok) std::cerr << "Error: cannot read " << input << "\n";
+    ok = ok && refine();
+    if(ok && duplicates) std::cerr << "Warning: " << duplicates << " transitions in " << input << " share source and symbol with another one, "
+                                   << "the automaton is nondeterministic and only the last of each was kept (see NFA).\n";
+    //Beide Ausgaben lesen dieselben sortierten Dateien des minimalen Automaten
+    if(ok && !tfsm.empty() && !write_tfsm(tfsm)){
+      std::cerr << "Error: cannot write " << tfsm << "\n";
+      ok = false;
+    }
+    if(ok && !binary.empty() && !write_binary(binary)){
+      std::cerr << "Error: cannot write " << binary << "\n";
+      ok = false;
+    }
+    cleanup();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return ok;
+  }
+
+  ///@brief Die Anzahl der Zustände der Eingabe
+  unsigned states() const{
+    return state_count + unreachable + dead;
+  }
+
+  ///@brief Die Anzahl der Übergänge der Eingabe (ohne doppelte)
+  std::uint64_t transitions() const{
+    return transition_count + pruned;
+  }
+
+  ///@brief Die Anzahl der entfernten unerreichbaren Zustände
+  unsigned unreachable_states() const{
+    return unreachable;
+  }
+
+  ///@brief Die Anzahl der entfernten erreichbaren, aber toten Zustände
+  unsigned dead_states() const{
+    return dead;
+  }
+
+  ///@brief Die Anzahl der mit den unerreichbaren und toten Zuständen entfernten Übergänge
+  std::uint64_t pruned_transitions() const{
+    return pruned;
+  }
+
+  ///@brief Die Anzahl der Runden beim Entfernen unerreichbarer und toter Zustände
+  unsigned trim_rounds() const{
+    return reach_rounds;
+  }
+
+  ///@brief Die Anzahl der Zustände des minimalen Automaten
+  unsigned minimal_states() const{
+    return block_count;
+  }
+
+  ///@brief Die Anzahl der Übergänge des minimalen Automaten
+  std::uint64_t minimal_transitions() const{
+    return minimal_count;
+  }
+
+  ///@brief Die Anzahl der Verfeinerungsrunden
+  unsigned rounds() const{
+    return round_count;
+  }
+
+  ///@brief Die Anzahl doppelter Übergänge (gleiche Quelle, gleiches Symbol), von denen nur der letzte übernommen wurde
+  std::uint64_t duplicate_arcs() const{
+    return duplicates;
+  }
+
+  ///@brief Die Anzahl fehlerhafter Zeilen der Eingabe
+  std::uint64_t malformed_lines() const{
+    return malformed;
+  }
+
+  ///@brief Die Anzahl der in temporäre Dateien geschriebenen Bytes
+  std::uint64_t io_bytes() const{
+    return written;
+  }
+
+  ///@brief Die Dauer des letzten Aufrufs in Sekunden
+  double duration() const{
+    return seconds;
+  }
+
+  private:
+
+  ///	@brief Ein eingelesener Übergang, position ordnet doppelte nach der Dateireihenfolge
+  struct Arc{
+    std::uint32_t source; ///< Der Ausgangszustand
+    std::uint32_t target; ///< Der Zielzustand
+    std::uint64_t position; ///< Die laufende Nummer in der Datei
+    std::uint32_t symbol; ///< Das Symbol als unsigned char
+  };
+
+  ///	@brief Ein Übergang, dessen Ziel je nach Datei ein Zustand oder ein Block ist
+  struct Edge{
+    std::uint32_t source; ///< Der Ausgangszustand
+    std::uint32_t target; ///< Der Zielzustand bzw. sein Block
+    std::uint32_t symbol; ///< Das Symbol als unsigned char
+  };
+
+  ///	@brief Die Zuordnung eines Zustands zu seinem Block
+  struct Label{
+    std::uint32_t state; ///< Der Zustand
+    std::uint32_t block; ///< Der Block
+  };
+
+  struct ByPosition{
+    bool operator()(const Arc& a, const Arc& b) const{
+      if(a.source != b.source) return a.source < b.source;
+      if(a.symbol != b.symbol) return a.symbol < b.symbol;
+      return a.position < b.position;
+    }
+  };
+
+  struct BySource{
+    bool operator()(const Edge& a, const Edge& b) const{
+      return a.source != b.source ? a.source < b.source : a.symbol < b.symbol;
+    }
+  };
+
+  struct ByTarget{
+    bool operator()(const Edge& a, const Edge& b) const{
+      return a.target < b.target;
+    }
+  };
+
+  struct ByState{
+    bool operator()(const Label& a, const Label& b) const{
+      return a.state < b.state;
+    }
+  };
+
+  void clear(){
+    state_count = 0;
+    transition_count = 0;
+    block_count = 0;
+    minimal_count = 0;
+    round_count = 0;
+    reach_rounds = 0;
+    unreachable = 0;
+    dead = 0;
+    pruned = 0;
+    duplicates = 0;
+    malformed = 0;
+    written = 0;
+    start_state = 0;
+    start_block = 0;
+    seconds = 0;
+    alphabet.clear();
+  }
+
+  //Der Name einer temporären Datei
+  std::string file(const std::string& name) const{
+    return prefix + "." + name;
+  }
+
+  //Löscht alle temporären Dateien, auch nach einem Abbruch
+  void cleanup(){
+    const char* names[] = {"arcs","arcs.sorted","finals","finals.sorted","edges","by_target","blocks","successors","successors.sorted",
+                           "labels","labels.sorted","minimal","minimal.sorted","minimal_finals","minimal_finals.sorted",
+                           "reachable","productive","reached","reached.sorted","marks.next","numbers","edges.live","edges.sorted","finals.live"};
+    for(const char* n : names) std::remove(file(n).c_str());
+    for(unsigned b = 0;b!=buckets;++b) std::remove(file("bucket" + std::to_string(b)).c_str());
+  }
+
+  template<class Record, class Less>
+  bool sort(const std::string& input, const std::string& output, Less less){
+    ExternalSort<Record,Less> sorter(budget,less);
+    bool ok = sorter(file(input),file(output));
+    written += sorter.bytes();
+    return ok;
+  }
+
+  //Liest die Eingabe in Stücken über TfsmReader::parse und schreibt Übergänge und Endzustände
+  bool read(const std::string& input){
+    std::ifstream in(input.c_str(),std::ios::binary);
+    if(!in) return false;
+    RecordWriter<Arc> arcs(file("arcs"));
+    RecordWriter<std::uint32_t> finals(file("finals"));
+    std::size_t block = std::min<std::size_t>(std::max<std::size_t>(budget / 8,1u << 16),1u << 26);
+    std::vector<char> buffer(block);
+    std::size_t kept = 0;
+    bool have_start = false, have_final = false;
+    std::uint32_t first_final = 0;
+    std::uint64_t position = 0;
+    bool seen[256] = {false};
+    state_count = 1;
+    while(true){
+      in.read(buffer.data() + kept,buffer.size() - kept);
+      std::size_t size = kept + in.gcount();
+      bool done = !in;
+      std::size_t end = size;
+      if(!done){
+        //Nur vollständige Zeilen parsen, der Rest kommt an den Anfang des Puffers
+        while(end && buffer[end-1] != '\n') --end;
+        if(!end){
+          kept = size;
+          buffer.resize(buffer.size() * 2);
+          continue;
+        }
+      }
+      TfsmReader::Chunk chunk;
+      TfsmReader::parse(buffer.data(),buffer.data() + end,chunk);
+      if(!chunk.long_arcs.empty()){
+        std::cerr << "Error: out-of-core minimization supports only single-byte symbols.\n";
+        return false;
+      }
+      malformed += chunk.malformed;
+      if(chunk.states > state_count) state_count = chunk.states;
+      if(!have_start && chunk.has_start){
+        have_start = true;
+        start_state = chunk.start;
+      }
+      if(!have_final && !chunk.finals.empty()){
+        have_final = true;
+        first_final = chunk.finals.front();
+      }
+      for(auto c = chunk.symbols.begin();c!=chunk.symbols.end();++c){
+        if(!seen[(unsigned char)*c]){
+          seen[(unsigned char)*c] = true;
+          alphabet += *c;
+        }
+      }
+      for(auto it = chunk.arcs.begin();it!=chunk.arcs.end();++it){
+        Arc a;
+        a.source = it->source;
+        a.target = it->target;
+        a.position = position++;
+        a.symbol = (unsigned char)it->symbol;
+        arcs.push_back(a);
+      }
+      for(auto it = chunk.finals.begin();it!=chunk.finals.end();++it) finals.push_back(*it);
+      if(done) break;
+      std::memmove(buffer.data(),buffer.data() + end,size - end);
+      kept = size - end;
+    }
+    if(!have_start) start_state = first_final;
+    written += arcs.size() * sizeof(Arc) + finals.size() * 4;
+    return arcs.close() && finals.close() && !in.bad();
+  }
+
+  //Sortiert die Eingabe: doppelte Übergänge entfernen (der letzte gilt), dann nach Ziel ordnen
+  bool prepare(){
+    if(!sort<Arc>("arcs","arcs.sorted",ByPosition())) return false;
+    {
+      RecordReader<Arc> in(file("arcs.sorted"));
+      RecordWriter<Edge> out(file("edges"));
+      Arc a, last;
+      bool have = in.next(last);
+      while(have){
+        bool more = in.next(a);
+        if(more && a.source == last.source && a.symbol == last.symbol) ++duplicates;
+        else{
+          Edge e;
+          e.source = last.source;
+          e.target = last.target;
+          e.symbol = last.symbol;
+          out.push_back(e);
+        }
+        last = a;
+        have = more;
+      }
+      transition_count = out.size();
+      written += out.size() * sizeof(Edge);
+      if(!out.close()) return false;
+    }
+    std::remove(file("arcs.sorted").c_str());
+    if(!sort<std::uint32_t>("finals","finals.sorted",std::less<std::uint32_t>())) return false;
+    //prune() braucht die Übergänge noch nach Quelle und sortiert sie selbst nach Ziel
+    if(trim ? !prune() : !sort<Edge>("edges","by_target",ByTarget())) return false;
+    //Anfangs liegen alle Zustände in einem Block, die erste Runde trennt die Endzustände ab
+    RecordWriter<std::uint32_t> blocks(file("blocks"));
+    for(unsigned s = 0;s!=state_count;++s) blocks.push_back(0);
+    written += blocks.size() * 4;
+    return blocks.close();
+  }
+
+  //Entfernt unerreichbare und tote Zustände und nummeriert die übrigen in alter Reihenfolge neu.
+  //Liest "edges" (nach Quelle sortiert) und schreibt "by_target" und "finals.sorted" nur mit
+  //lebenden Zuständen und neuen Nummern.
+  bool prune(){
+    //Marken je Zustand in Zustandsreihenfolge: 0 = nicht erreicht, 2 = in der letzten Runde neu, 1 = erreicht
+    {
+      RecordWriter<std::uint8_t> forward(file("reachable"));
+      RecordWriter<std::uint8_t> backward(file("productive"));
+      RecordReader<std::uint32_t> finals(file("finals.sorted"));
+      std::uint32_t f;
+      bool more = finals.next(f);
+      for(std::uint32_t s = 0;s!=state_count;++s){
+        for(;more && f < s;more = finals.next(f));
+        forward.push_back(s == start_state ? 2 : 0);
+        backward.push_back(more && f == s ? 2 : 0);
+      }
+      written += forward.size() + backward.size();
+      if(!forward.close() || !backward.close()) return false;
+    }
+    if(!reach("edges",true,"reachable")) return false;
+    if(!sort<Edge>("edges","by_target",ByTarget())) return false;
+    if(!reach("by_target",false,"productive")) return false;
+    //Die neuen Nummern, NONE für entfernte Zustände; der Startzustand bleibt immer erhalten
+    {
+      RecordReader<std::uint8_t> forward(file("reachable"));
+      RecordReader<std::uint8_t> backward(file("productive"));
+      RecordWriter<std::uint32_t> numbers(file("numbers"));
+      std::uint32_t live = 0, start = start_state;
+      for(std::uint32_t s = 0;s!=state_count;++s){
+        std::uint8_t r = 0, p = 0;
+        forward.next(r);
+        backward.next(p);
+        if(s == start || (r && p)){
+          if(s == start) start_state = live;
+          numbers.push_back(live++);
+        }
+        else{
+          numbers.push_back(NONE);
+          if(!r) ++unreachable;
+          else ++dead;
+        }
+      }
+      written += numbers.size() * 4;
+      if(!numbers.close()) return false;
+      state_count = live;
+    }
+    std::remove(file("reachable").c_str());
+    std::remove(file("productive").c_str());
+    if(!unreachable && !dead){
+      std::remove(file("numbers").c_str());
+      return true;
+    }
+    //Erst die Ziele umschreiben, nach Quelle sortieren, die Quellen umschreiben und wieder nach Ziel sortieren
+    std::uint64_t before = transition_count;
+    if(!relabel("by_target","edges.live",false)) return false;
+    if(!sort<Edge>("edges.live","edges.sorted",BySource())) return false;
+    if(!relabel("edges.sorted","edges",true)) return false;
+    std::remove(file("edges.sorted").c_str());
+    if(!sort<Edge>("edges","by_target",ByTarget())) return false;
+    pruned = before - transition_count;
+    {
+      RecordReader<std::uint32_t> finals(file("finals.sorted"));
+      RecordReader<std::uint32_t> numbers(file("numbers"));
+      RecordWriter<std::uint32_t> out(file("finals.live"));
+      std::uint32_t f, state = 0, number = NONE;
+      numbers.next(number);
+      while(finals.next(f)){
+        for(;state < f;++state) numbers.next(number);
+        if(number != NONE) out.push_back(number);
+      }
+      written += out.size() * 4;
+      if(!out.close()) return false;
+    }
+    std::remove(file("numbers").c_str());
+    return replace("finals.live","finals.sorted");
+  }
+
+  //Markiert in Runden alle Zustände, die von den Zuständen mit Marke 2 aus erreichbar sind:
+  //vorwärts über die nach Quelle sortierte Datei, rückwärts über die nach Ziel sortierte
+  bool reach(const std::string& edges, bool forward, const std::string& marks){
+    while(true){
+      ++reach_rounds;
+      //Die Nachbarn der zuletzt neu markierten Zustände
+      {
+        RecordReader<Edge> in(file(edges));
+        RecordReader<std::uint8_t> m(file(marks));
+        RecordWriter<std::uint32_t> out(file("reached"));
+        std::uint32_t state = 0;
+        std::uint8_t mark = 0;
+        m.next(mark);
+        Edge e;
+        while(in.next(e)){
+          std::uint32_t from = forward ? e.source : e.target;
+          for(;state < from;++state) m.next(mark);
+          if(mark == 2) out.push_back(forward ? e.target : e.source);
+        }
+        written += out.size() * 4;
+        if(!out.close()) return false;
+      }
+      if(!sort<std::uint32_t>("reached","reached.sorted",std::less<std::uint32_t>())) return false;
+      //Neue Marken: die bisher neuen sind alt, noch nicht markierte Nachbarn sind neu
+      std::uint64_t added = 0;
+      {
+        RecordReader<std::uint8_t> m(file(marks));
+        RecordReader<std::uint32_t> reached(file("reached.sorted"));
+        RecordWriter<std::uint8_t> out(file("marks.next"));
+        std::uint32_t t;
+        bool more = reached.next(t);
+        for(std::uint32_t s = 0;s!=state_count;++s){
+          std::uint8_t mark = 0;
+          m.next(mark);
+          for(;more && t < s;more = reached.next(t));
+          if(mark == 2) mark = 1;
+          else if(!mark && more && t == s){
+            mark = 2;
+            ++added;
+          }
+          out.push_back(mark);
+        }
+        written += out.size();
+        if(!out.close()) return false;
+      }
+      if(!replace("marks.next",marks)) return false;
+      if(!added) return true;
+    }
+  }
+
+  //Schreibt die Übergänge mit neuen Nummern der Quelle (source = true) bzw. des Ziels,
+  //die Eingabe ist danach sortiert; Übergänge von oder zu entfernten Zuständen fallen weg
+  bool relabel(const std::string& input, const std::string& output, bool source){
+    RecordReader<Edge> in(file(input));
+    RecordReader<std::uint32_t> numbers(file("numbers"));
+    RecordWriter<Edge> out(file(output));
+    std::uint32_t state = 0, number = NONE;
+    numbers.next(number);
+    Edge e;
+    while(in.next(e)){
+      std::uint32_t& key = source ? e.source : e.target;
+      for(;state < key;++state) numbers.next(number);
+      if(number == NONE) continue;
+      key = number;
+      out.push_back(e);
+    }
+    transition_count = out.size();
+    written += out.size() * sizeof(Edge);
+    return out.close();
+  }
+
+  //Ersetzt eine temporäre Datei durch eine andere
+  bool replace(const std::string& from, const std::string& to){
+    std::remove(file(to).c_str());
+    return std::rename(file(from).c_str(),file(to).c_str()) == 0;
+  }
+
+  //Verfeinert die Partition in Runden, bis die Anzahl der Blöcke gleich bleibt
+  bool refine(){
+    if(!prepare()) return false;
+    //Die Eimer sollen mit ihrer Hashtabelle (etwa 64 Bytes je Eintrag) in das Budget passen
+    std::uint64_t estimate = std::uint64_t(state_count) * (64 + 8) + transition_count * 5;
+    buckets = std::min<std::uint64_t>(estimate / budget + 1,256);
+    unsigned count = 1;
+    while(true){
+      ++round_count;
+      //Ziele durch ihre Blöcke ersetzen
+      {
+        RecordReader<Edge> in(file("by_target"));
+        RecordReader<std::uint32_t> blocks(file("blocks"));
+        RecordWriter<Edge> out(file("successors"));
+        std::uint32_t state = 0, block = 0;
+        blocks.next(block);
+        Edge e;
+        while(in.next(e)){
+          for(;state < e.target;++state) blocks.next(block);
+          e.target = block;
+          out.push_back(e);
+        }
+        written += out.size() * sizeof(Edge);
+        if(!out.close()) return false;
+      }
+      if(!sort<Edge>("successors","successors.sorted",BySource())) return false;
+      if(!distribute()) return false;
+      std::remove(file("successors.sorted").c_str());
+      unsigned next = 0;
+      if(!number(next)) return false;
+      if(next == count) break;
+      count = next;
+      //Die neue Blockdatei in Zustandsreihenfolge
+      if(!sort<Label>("labels","labels.sorted",ByState())) return false;
+      RecordReader<Label> in(file("labels.sorted"));
+      RecordWriter<std::uint32_t> blocks(file("blocks"));
+      Label l;
+      while(in.next(l)) blocks.push_back(l.block);
+      written += blocks.size() * 4;
+      if(!blocks.close()) return false;
+    }
+    block_count = count;
+    return sort<Edge>("minimal","minimal.sorted",BySource())
+        && sort<std::uint32_t>("minimal_finals","minimal_finals.sorted",std::less<std::uint32_t>());
+  }
+
+  //Schreibt die Signatur jedes Zustands in den Eimer ihres Hashwerts
+  bool distribute(){
+    std::vector<std::unique_ptr<std::ofstream> > out(buckets);
+    for(unsigned b = 0;b!=buckets;++b){
+      out[b].reset(new std::ofstream(file("bucket" + std::to_string(b)).c_str(),std::ios::binary));
+    }
+    RecordReader<Edge> successors(file("successors.sorted"));
+    RecordReader<std::uint32_t> blocks(file("blocks"));
+    RecordReader<std::uint32_t> finals(file("finals.sorted"));
+    Edge e;
+    bool more = successors.next(e);
+    std::uint32_t f;
+    bool have_final = finals.next(f);
+    std::string signature;
+    for(std::uint32_t s = 0;s!=state_count;++s){
+      std::uint32_t block = 0;
+      blocks.next(block);
+      if(s == start_state) start_block = block;
+      while(have_final && f < s) have_final = finals.next(f);
+      signature.assign(reinterpret_cast<const char*>(&block),4);
+      signature += char(have_final && f == s);
+      for(;more && e.source == s;more = successors.next(e)){
+        signature += char(e.symbol);
+        signature.append(reinterpret_cast<const char*>(&e.target),4);
+      }
+      //Andere Bits als die Hashtabelle im Eimer, sonst landen alle Einträge in wenigen ihrer Buckets
+      std::uint64_t h = std::hash<std::string>()(signature) * 0x9e3779b97f4a7c15ULL;
+      std::ostream& o = *out[(h >> 32) % buckets];
+      std::uint32_t length = signature.size();
+      o.write(reinterpret_cast<const char*>(&s),4);
+      o.write(reinterpret_cast<const char*>(&length),4);
+      o.write(signature.data(),length);
+      written += 8 + length;
+    }
+    bool ok = true;
+    for(unsigned b = 0;b!=buckets;++b){
+      out[b]->close();
+      ok = ok && !out[b]->fail();
+    }
+    return ok;
+  }
+
+  //Nummeriert die Signaturen eimerweise durch; die erste Signatur jedes Blocks
+  //wird mit den alten Blocknummern als sein Zustand im minimalen Automaten geschrieben
+  bool number(unsigned& next){
+    RecordWriter<Label> labels(file("labels"));
+    RecordWriter<Edge> minimal(file("minimal"));
+    RecordWriter<std::uint32_t> minimal_finals(file("minimal_finals"));
+    //Der Startzustand wird mit Zustand 0 vertauscht, damit seine Übergänge in der Ausgabe zuerst stehen
+    auto renumber = [this](std::uint32_t b){ return b == start_block ? 0 : b == 0 ? start_block : b; };
+    minimal_count = 0;
+    for(unsigned b = 0;b!=buckets;++b){
+      std::string name = file("bucket" + std::to_string(b));
+      std::ifstream in(name.c_str(),std::ios::binary);
+      std::unordered_map<std::string,std::uint32_t> ids;
+      std::uint32_t s, length;
+      std::string signature;
+      while(in.read(reinterpret_cast<char*>(&s),4) && in.read(reinterpret_cast<char*>(&length),4)){
+        signature.resize(length);
+        in.read(&signature[0],length);
+        auto it = ids.find(signature);
+        if(it == ids.end()){
+          it = ids.insert(std::make_pair(signature,next++)).first;
+          std::uint32_t block;
+          std::memcpy(&block,signature.data(),4);
+          if(signature[4]) minimal_finals.push_back(renumber(block));
+          for(std::size_t i = 5;i<length;i+=5){
+            Edge e;
+            e.source = renumber(block);
+            e.symbol = (unsigned char)signature[i];
+            std::memcpy(&e.target,signature.data()+i+1,4);
+            e.target = renumber(e.target);
+            minimal.push_back(e);
+            ++minimal_count;
+          }
+        }
+        Label l;
+        l.state = s;
+        l.block = it->second;
+        labels.push_back(l);
+      }
+      in.close();
+      std::remove(name.c_str());
+    }
+    written += labels.size() * sizeof(Label) + minimal.size() * sizeof(Edge) + minimal_finals.size() * 4;
+    return labels.close() && minimal.close() && minimal_finals.close();
+  }
+
+  //Schreibt den minimalen Automaten im AT&T-Format
+  bool write_tfsm(const std::string& output){
+    std::ofstream out(output.c_str(),std::ios::binary);
+    RecordReader<Edge> arcs(file("minimal.sorted"));
+    Edge e;
+    while(arcs.next(e)) out << e.source << '\t' << e.target << '\t' << char(e.symbol) << '\n';
+    RecordReader<std::uint32_t> finals(file("minimal_finals.sorted"));
+    std::uint32_t f;
+    while(finals.next(f)) out << f << '\n';
+    out.close();
+    return !out.fail();
+  }
+
+  //Schreibt den minimalen Automaten abschnittsweise im Binärformat,
+  //der Header mit Prüfsumme folgt zum Schluss
+  bool write_binary(const std::string& output){
+    std::ofstream out(output.c_str(),std::ios::binary);
+    BinaryFormat::Header h;
+    std::memset(&h,0,sizeof(h));
+    out.write(reinterpret_cast<const char*>(&h),sizeof(h));
+    std::uint64_t size = 0;
+    std::uint64_t sum = BinaryFormat::checksum(nullptr,0);
+    auto emit = [&](const void* data, std::size_t n){
+      out.write(static_cast<const char*>(data),n);
+      sum = BinaryFormat::checksum(static_cast<const char*>(data),n,sum);
+      size += n;
+    };
+    auto pad = [&](){
+      const char zero = 0;
+      while(size % 4) emit(&zero,1);
+    };
+    Edge e;
+    {
+      RecordReader<Edge> arcs(file("minimal.sorted"));
+      std::uint32_t offset = 0;
+      bool more = arcs.next(e);
+      for(std::uint32_t s = 0;s!=block_count;++s){
+        emit(&offset,4);
+        for(;more && e.source == s;more = arcs.next(e)) ++offset;
+      }
+      emit(&offset,4);
+    }
+    {
+      RecordReader<Edge> arcs(file("minimal.sorted"));
+      while(arcs.next(e)) emit(&e.target,4);
+    }
+    {
+      RecordReader<Edge> arcs(file("minimal.sorted"));
+      while(arcs.next(e)){
+        char c = e.symbol;
+        emit(&c,1);
+      }
+      pad();
+    }
+    {
+      RecordReader<std::uint32_t> finals(file("minimal_finals.sorted"));
+      std::uint32_t f;
+      bool more = finals.next(f);
+      for(std::uint32_t w = 0;w!=(block_count+31)/32;++w){
+        std::uint32_t bits = 0;
+        for(;more && f/32 == w;more = finals.next(f)) bits |= std::uint32_t(1) << (f%32);
+        emit(&bits,4);
+      }
+    }
+    emit(alphabet.data(),alphabet.size());
+    pad();
+
+    std::memcpy(h.magic,"HOPCDFA",8);
+    h.byte_order = 0x01020304;
+    h.version = BinaryFormat::VERSION;
+    h.header_size = sizeof(h);
+    h.state_count = block_count;
+    h.transition_count = minimal_count;
+    h.start_state = 0;
+    h.alphabet_size = alphabet.size();
+    h.file_size = sizeof(h) + size;
+    h.checksum = sum;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h),sizeof(h));
+    out.close();
+    return !out.fail();
+  }
+
+  static constexpr std::uint32_t NONE = ~std::uint32_t(0); ///< Ein entfernter Zustand
+
+  std::size_t budget; ///< Das Speicherbudget in Bytes
+  std::string prefix; ///< Der Anfang der Namen aller temporären Dateien
+  unsigned buckets; ///< Die Anzahl der Eimer für die Signaturen
+  unsigned state_count; ///< Die Anzahl der Zustände der Eingabe
+  std::uint64_t transition_count; ///< Die Anzahl der Übergänge der Eingabe
+  unsigned block_count; ///< Die Anzahl der Blöcke der stabilen Partition
+  std::uint64_t minimal_count; ///< Die Anzahl der Übergänge des minimalen Automaten
+  unsigned round_count; ///< Die Anzahl der Runden
+  unsigned reach_rounds; ///< Die Anzahl der Runden beim Entfernen unerreichbarer und toter Zustände
+  bool trim; ///< true wenn unerreichbare und tote Zustände entfernt werden
+  unsigned unreachable; ///< Die Anzahl der entfernten unerreichbaren Zustände
+  unsigned dead; ///< Die Anzahl der entfernten toten Zustände
+  std::uint64_t pruned; ///< Die Anzahl der mit ihnen entfernten Übergänge
+  std::uint64_t duplicates; ///< Die Anzahl doppelter Übergänge
+  std::uint64_t malformed; ///< Die Anzahl fehlerhafter Zeilen
+  std::uint64_t written; ///< Die Anzahl der in temporäre Dateien geschriebenen Bytes
+  std::uint32_t start_state; ///< Der Startzustand der Eingabe
+  std::uint32_t start_block; ///< Der Block des Startzustands
+  double seconds; ///< Die Dauer des letzten Aufrufs
+  std::string alphabet; ///< Die Symbole in der Reihenfolge ihres ersten Auftretens
+
+};
+
+#endif
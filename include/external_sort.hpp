@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+// external_sort.hpp
+// Klasse für das Hopcroft Projekt
+// Datensätze fester Größe in Dateien, Sortieren mit beschränktem Speicher
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __EXTERNAL_SORT_HPP__
+#define __EXTERNAL_SORT_HPP__
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <queue>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include "parallel.hpp"
+
+/** @brief Schreibt Datensätze fester Größe gepuffert in eine Datei
+
+    Die Datensätze werden so geschrieben, wie sie im Speicher liegen; Record muss
+    also trivial kopierbar sein.
+*/
+template<class Record>
+class RecordWriter{
+
+  public:
+
+  /** @brief Der Konstruktor der Klasse, legt die Datei neu an
+      @param filename Der Name der Datei
+      @param buffer optional: die Größe des Puffers in Bytes. Default = 64 KB
+  */
+  RecordWriter(const std::string& filename, std::size_t buffer = 1u << 16)
+    : out(filename.c_str(),std::ios::binary){
+    records.reserve(buffer / sizeof(Record) + 1);
+    count = 0;
+  }
+
+  ///@brief Der Destruktor schreibt den Rest des Puffers
+  ~RecordWriter(){
+    flush();
+  }
+
+  ///@brief Hängt einen Datensatz an
+  void push_back(const Record& r){
+    records.push_back(r);
+    ++count;
+    if(records.size() == records.capacity()) flush();
+  }
+
+  ///@brief Die Anzahl der geschriebenen Datensätze
+  std::uint64_t size() const{
+    return count;
+  }
+
+  /** @brief Schreibt den Rest des Puffers und schließt die Datei
+      @return false wenn nicht alles geschrieben werden konnte
+  */
+  bool close(){
+    flush();
+    out.close();
+    return !out.fail();
+  }
+
+  private:
+
+  void flush(){
+    if(records.empty()) return;
+    out.write(reinterpret_cast<const char*>(records.data()),records.size() * sizeof(Record));
+    records.clear();
+  }
+
+  std::ofstream out; ///< Die Datei
+  std::vector<Record> records; ///< Der Puffer
+  std::uint64_t count; ///< Die Anzahl der geschriebenen Datensätze
+
+};
+
+/** @brief Liest Datensätze fester Größe gepuffert aus einer Datei
+*/
+template<class Record>
+class RecordReader{
+
+  public:
+
+  /** @brief Der Konstruktor der Klasse
+      @param filename Der Name der Datei
+      @param buffer optional: die Größe des Puffers in Bytes. Default = 64 KB
+  */
+  RecordReader(const std::string& filename, std::size_t buffer = 1u << 16)
+    : in(filename.c_str(),std::ios::binary){
+    records.resize(buffer / sizeof(Record) + 1);
+    position = 0;
+    filled = 0;
+  }
+
+  ///@brief false wenn die Datei nicht geöffnet werden konnte
+  bool good() const{
+    return in.is_open();
+  }
+
+  /** @brief Liest den nächsten Datensatz
+      @param r Der Datensatz
+      @return false am Ende der Datei
+  */
+  bool next(Record& r){
+    if(position == filled){
+      in.read(reinterpret_cast<char*>(records.data()),records.size() * sizeof(Record));
+      filled = in.gcount() / sizeof(Record);
+      position = 0;
+      if(!filled) return false;
+    }
+    r = records[position++];
+    return true;
+  }
+
+  private:
+
+  std::ifstream in; ///< Die Datei
+  std::vector<Record> records; ///< Der Puffer
+  std::size_t position; ///< Der nächste Datensatz im Puffer
+  std::size_t filled; ///< Die Anzahl der Datensätze im Puffer
+
+};
+
+/** @brief Sortiert eine Datei aus Datensätzen fester Größe mit beschränktem Speicher
+
+    Die Eingabe wird in Läufe zerlegt, die jeweils in das Budget passen, im
+    Speicher sortiert und einzeln geschrieben. Anschließend werden je bis zu
+    fan_in Läufe über einen Heap zusammengeführt, bis nur noch die Ausgabe übrig
+    ist. Passt die Eingabe in einen Lauf, wird sie direkt geschrieben.
+*/
+template<class Record, class Less = std::less<Record> >
+class ExternalSort{
+
+  public:
+
+  /** @brief Der Konstruktor der Klasse
+      @param budget Der Speicher für einen Lauf in Bytes
+      @param less optional: die Ordnung der Datensätze
+  */
+  ExternalSort(std::size_t budget, Less less = Less()) : less(less){
+    run_size = budget / sizeof(Record);
+    if(run_size < 1024) run_size = 1024;
+    //Jeder zusammengeführte Lauf bekommt mindestens 64 KB Puffer
+    fan_in = budget >> 16;
+    if(fan_in < 2) fan_in = 2;
+    if(fan_in > 64) fan_in = 64;
+    budget_bytes = budget;
+    written = 0;
+  }
+
+  /** @brief Sortiert eine Datei in eine andere, die Eingabe wird danach gelöscht
+      @param input Die Eingabedatei
+      @param output Die Ausgabedatei, Läufe werden als output.0, output.1, ... angelegt
+      @return false wenn eine Datei nicht gelesen oder geschrieben werden konnte
+  */
+  bool operator()(const std::string& input, const std::string& output){
+    std::vector<std::string> runs;
+    {
+      RecordReader<Record> in(input);
+      if(!in.good()) return false;
+      std::vector<Record> run;
+      run.reserve(run_size);
+      Record r;
+      bool more = in.next(r);
+      while(more){
+        run.clear();
+        do run.push_back(r); while((more = in.next(r)) && run.size() != run_size);
+        Parallel::parallel_sort(run.begin(),run.end(),less);
+        //Der einzige Lauf ist schon die Ausgabe
+        std::string name = (!more && runs.empty()) ? output : output + "." + std::to_string(runs.size());
+        if(!write(run,name)) return false;
+        runs.push_back(name);
+      }
+    }
+    std::remove(input.c_str());
+    if(runs.empty()) return write(std::vector<Record>(),output);
+    //Zusammenführen, bis nur noch ein Lauf übrig ist
+    unsigned generation = 0;
+    while(runs.size() > 1){
+      std::vector<std::string> merged;
+      for(std::size_t i = 0;i<runs.size();i+=fan_in){
+        std::size_t last = std::min(runs.size(),i+fan_in);
+        std::string name = runs.size() <= fan_in ? output
+                         : output + ".m" + std::to_string(generation) + "." + std::to_string(merged.size());
+        if(last - i == 1) std::rename(runs[i].c_str(),name.c_str());
+        else if(!merge(runs.begin()+i,runs.begin()+last,name)) return false;
+        merged.push_back(name);
+      }
+      runs.swap(merged);
+      ++generation;
+    }
+    return true;
+  }
+
+  ///@brief Die Anzahl aller bisher geschriebenen Bytes, für die Statistik
+  std::uint64_t bytes() const{
+    return written;
+  }
+
+  private:
+
+  //Schreibt einen sortierten Lauf
+  bool write(const std::vector<Record>& run, const std::string& name){
+    RecordWriter<Record> out(name);
+    for(auto it = run.begin();it!=run.end();++it) out.push_back(*it);
+    written += run.size() * sizeof(Record);
+    return out.close();
+  }
+
+  //Führt sortierte Läufe zusammen und löscht sie
+  bool merge(std::vector<std::string>::const_iterator first, std::vector<std::string>::const_iterator last,
+             const std::string& name){
+    std::size_t buffer = budget_bytes / (last - first + 1);
+    std::vector<RecordReader<Record>*> readers;
+    typedef std::pair<Record,std::size_t> Head;
+    auto greater = [this](const Head& a, const Head& b){ return less(b.first,a.first); };
+    std::priority_queue<Head,std::vector<Head>,decltype(greater)> heads(greater);
+    for(auto it = first;it!=last;++it){
+      readers.push_back(new RecordReader<Record>(*it,buffer));
+      Record r;
+      if(readers.back()->next(r)) heads.push(Head(r,readers.size()-1));
+    }
+    RecordWriter<Record> out(name,buffer);
+    while(!heads.empty()){
+      Head h = heads.top();
+      heads.pop();
+      out.push_back(h.first);
+      if(readers[h.second]->next(h.first)) heads.push(h);
+    }
+    written += out.size() * sizeof(Record);
+    for(std::size_t i = 0;i!=readers.size();++i){
+      delete readers[i];
+      std::remove(first[i].c_str());
+    }
+    return out.close();
+  }
+
+  Less less; ///< Die Ordnung der Datensätze
+  std::size_t run_size; ///< Die Anzahl der Datensätze je Lauf
+  std::size_t fan_in; ///< Die Anzahl der Läufe, die auf einmal zusammengeführt werden
+  std::size_t budget_bytes; ///< Das Speicherbudget in Bytes
+  std::uint64_t written; ///< Die Anzahl der geschriebenen Bytes
+
+};
+
+#endif
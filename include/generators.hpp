@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+// generators.hpp
+// Klasse für das Hopcroft Projekt
+// Erzeugung synthetischer Automaten und Lexika für Benchmarks
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __GENERATORS_HPP__
+#define __GENERATORS_HPP__
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <random>
+#include <algorithm>
+#include <unordered_set>
+#include <cstdint>
+
+/** @brief Erzeugt reproduzierbare Eingaben für Benchmarks
+
+    Automaten werden im AT&T-Format (tfsm) geschrieben, so dass sie wie echte
+    Eingaben eingelesen werden; Lexika sind Wortlisten für add_word bzw. Daciuk.
+    Verwendet wird nur die Rohausgabe von std::mt19937 (deren Folge vom Standard
+    festgelegt ist) und keine std::*_distribution, damit derselbe Startwert auf
+    allen Compilern dieselben Eingaben liefert.
+*/
+class Generator{
+
+  public:
+
+  /** @brief Der Konstruktor der Klasse
+      @param seed optional: der Startwert. Default = 1
+  */
+  Generator(std::uint32_t seed = 1) : random(seed){
+  }
+
+  /** @brief Ein zufälliger Automat: jeder Zustand hat für jedes Symbol (mit der
+             Wahrscheinlichkeit density_percent) einen Übergang zu einem zufälligen Ziel
+      @param o Der Ausgabestrom
+      @param states Die Anzahl der Zustände
+      @param symbols Die Anzahl der Symbole (ab 'a')
+      @param final_percent Der Anteil der Endzustände in Prozent
+      @param density_percent optional: der Anteil vorhandener Übergänge in Prozent. Default = 100 (vollständig)
+  */
+  void random_dfa(std::ostream& o, unsigned states, unsigned symbols, unsigned final_percent, unsigned density_percent = 100){
+    for(unsigned s = 0;s!=states;++s){
+      for(unsigned c = 0;c!=symbols;++c){
+        //Vollständige Automaten ziehen keine weiteren Zahlen, die Folge bleibt also dieselbe
+        if(density_percent < 100 && next(100) >= density_percent) continue;
+        o << s << '\t' << next(states) << '\t' << symbol(c) << '\n';
+      }
+    }
+    for(unsigned s = 0;s!=states;++s){
+      if(next(100) < final_percent) o << s << '\n';
+    }
+  }
+
+  /** @brief Eine lange Kette über einem Symbol, nur der letzte Zustand ist Endzustand.
+             Schlechtester Fall für rundenbasierte Verfahren (MOORE, HASHING): jede Runde
+             trennt nur einen Zustand ab, es gibt also so viele Runden wie Zustände.
+      @param o Der Ausgabestrom
+      @param states Die Anzahl der Zustände
+  */
+  void chain(std::ostream& o, unsigned states){
+    for(unsigned s = 0;s+1<states;++s) o << s << '\t' << s+1 << "\ta\n";
+    o << states-1 << '\n';
+  }
+
+  /** @brief Ein Zyklus über einem Symbol, dessen Endzustände einem Fibonacci-Wort folgen.
+             Nach Berstel und Carton braucht Hopcroft darauf Theta(n log n) Schritte,
+             die Schranke wird also tatsächlich erreicht.
+      @param o Der Ausgabestrom
+      @param states Die Anzahl der Zustände
+  */
+  void fibonacci_cycle(std::ostream& o, unsigned states){
+    std::string a = "0", b = "01";
+    while(b.size() < states){
+      std::string c = b + a;
+      a.swap(b);
+      b.swap(c);
+    }
+    for(unsigned s = 0;s!=states;++s) o << s << '\t' << (s+1) % states << "\ta\n";
+    for(unsigned s = 0;s!=states;++s){
+      if(b[s] == '1') o << s << '\n';
+    }
+  }
+
+  /** @brief Ein Lexikon aus zufälligen Wörtern
+
+      Mit der Wahrscheinlichkeit shared_percent beginnt ein neues Wort mit einem Präfix
+      eines bereits erzeugten Wortes (wie in natürlichen Lexika), sonst ist es
+      vollständig zufällig. Die Längen sind gleichverteilt aus [min_length, max_length].
+      @param words Die Wörter, sortiert und ohne Duplikate (weniger als count, wenn es nicht genug gibt)
+      @param count Die Anzahl der Wörter
+      @param symbols Die Anzahl der Symbole (ab 'a')
+      @param min_length Die kleinste Wortlänge
+      @param max_length Die größte Wortlänge
+      @param shared_percent Der Anteil der Wörter mit gemeinsamem Präfix in Prozent
+  */
+  void lexicon(std::vector<std::string>& words, unsigned count, unsigned symbols,
+               unsigned min_length, unsigned max_length, unsigned shared_percent){
+    words.clear();
+    words.reserve(count);
+    std::unordered_set<std::string> seen;
+    std::string word;
+    //Gibt es nicht genug verschiedene Wörter, wird nach einer Weile aufgegeben
+    for(std::size_t attempts = 0;words.size() < count && attempts < 16 * (std::size_t)count + 1024;++attempts){
+      unsigned length = min_length + next(max_length - min_length + 1);
+      word.clear();
+      if(!words.empty() && next(100) < shared_percent){
+        const std::string& other = words[next(words.size())];
+        word.assign(other,0,next(std::min<unsigned>(other.size(),length) + 1));
+      }
+      while(word.size() < length) word += symbol(next(symbols));
+      if(seen.insert(word).second) words.push_back(word);
+    }
+    std::sort(words.begin(),words.end());
+  }
+
+  private:
+
+  //Eine Zufallszahl aus [0,n)
+  unsigned next(unsigned n){
+    return n ? random() % n : 0;
+  }
+
+  //Das Symbol mit der Nummer c, ab 'a'
+  static char symbol(unsigned c){
+    return (char)('a' + c);
+  }
+
+  std::mt19937 random; ///< Der Zufallsgenerator
+
+};
+
+#endif
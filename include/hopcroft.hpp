@@ -2,71 +2,321 @@
 // hopcroft.hpp
 // Klasse für das Hopcroft Projekt
 // Marco Akrutat, 05.05.2016
-// Compiler: MSVC++ 14
+// Compiler: MSVC++ 14, g++/clang++
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <vector>
+#include <string>
 #include <algorithm>
-#include <ppl.h>
+#include <unordered_set>
+#include <chrono>
+#include "parallel.hpp"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "partition.hpp"
+
+//Statistiken der Minimierung; mit -DHOPCROFT_NO_STATS wird die Messung vollständig
+//wegkompiliert, stats() liefert dann nur Nullen
+#ifndef HOPCROFT_NO_STATS
+#define HOPCROFT_STATS(...) __VA_ARGS__
+#else
+#define HOPCROFT_STATS(...)
+#endif
 
 /// @brief Klasse zur Minimierung von deterministischen endlichen Automaten in Form der DFA-Klasse
 class Hopcroft{
   
   public:
   
-  /** @brief Operator () zur Minimierung eines Automaten
-      @param dfa Der zu minimierende Automat
+  /** @brief Die verfügbaren Verfahren zur Verfeinerung der Partitionen
+      
+      MOORE sortiert in jeder Runde alle Zustände neu, bis sich die Anzahl der
+      Partitionen nicht mehr ändert. WORKLIST ist der eigentliche Algorithmus von
+      Hopcroft mit Splitter-Worklist und "kleinerer Hälfte" in O(m log n).
+      REVUZ minimiert azyklische Automaten (z.B. Lexika) in einem einzigen Durchlauf
+      von den Blättern aufwärts; ist der Automat zyklisch, wird WORKLIST verwendet.
+      AUTOMATIC prüft auf Zyklen und wählt entsprechend REVUZ oder WORKLIST.
+      HASHING arbeitet in Runden wie MOORE, sortiert aber nicht: die Signaturen
+      (Partition und Partitionen der Nachfolger) werden parallel gehasht und über
+      eine Hashtabelle neu nummeriert, jede Runde ist damit linear.
+      Alle liefern denselben minimalen Automaten mit derselben Nummerierung.
   */
-  void operator()(DFA& dfa){
-    init(dfa);
-    first_step(dfa);
-    refine(dfa);
-    construct(dfa);
+  enum Engine{ MOORE, WORKLIST, REVUZ, AUTOMATIC, HASHING };
+  
+  /** @brief Der Konstruktor der Klasse
+      @param e optional: das Verfahren zur Verfeinerung. Default = MOORE
+  */
+  Hopcroft(Engine e = MOORE){
+    engine = e;
+    merge_symbols = false;
+    trim_states = true;
+    class_count = 0;
+    renumbering.set_order(Renumbering::KEEP);
   }
   
-  private:
+  /** @brief Wählt das Verfahren zur Verfeinerung
+      @param e das Verfahren
+  */
+  void set_engine(Engine e){
+    engine = e;
+  }
+  
+  /** @brief Schaltet das Zusammenfassen gleichwertiger Symbole ein oder aus
+  
+      Zwei Symbole sind gleichwertig, wenn sie in jedem Zustand zum selben Ziel
+      führen oder beide fehlen. Vor der Verfeinerung bleibt je Klasse nur ein
+      Symbol in den Zeilen stehen, danach werden die übrigen wieder ergänzt.
+      Lohnt sich bei großen Alphabeten (z.B. Bytes), in denen viele Symbole
+      gleich behandelt werden.
+      @param on true zum Einschalten. Default = aus
+  */
+  void set_symbol_classes(bool on){
+    merge_symbols = on;
+  }
+  
+  /** @brief Schaltet das Entfernen unerreichbarer und toter Zustände vor der Verfeinerung ein oder aus
+  
+      Solche Zustände entstehen z.B. durch Lücken in der Nummerierung einer tfsm-Datei
+      oder in maschinell erzeugten Automaten. Was entfernt wurde, liefert trimmed().
+      @param on true zum Einschalten. Default = ein
+  */
+  void set_trim(bool on){
+    trim_states = on;
+  }
+  
+  /** @brief Wählt eine Neunummerierung der minimalen Zustände nach der Konstruktion
+  
+      Ohne Neunummerierung folgen die Zustände den Blöcken der Partition. BFS, DFS
+      oder FREQUENCY legen nacheinander besuchte Zustände nebeneinander, siehe
+      Renumbering. Die Zuordnung der alten zu den neuen Nummern liefert layout().
+      @param o die Reihenfolge. Default = KEEP
+      @param sample optional: die Stichprobe von Abfragen für FREQUENCY, muss bis zur Minimierung erhalten bleiben
+  */
+  void set_layout(Renumbering::Order o, const std::vector<std::string>* sample = nullptr){
+    renumbering.set_order(o);
+    if(sample) renumbering.set_sample(*sample);
+  }
+  
+  /** @brief Der minimale Zustand je Zustand des Automaten vor der letzten Minimierung
+  
+      Damit lassen sich Daten je Zustand ohne weiteren Durchlauf in den minimalen
+      Automaten übernehmen. Beim Trimmen entfernte Zustände bilden auf
+      Transitions::NONE ab.
+  */
+  const std::vector<unsigned>& partition() const{
+    return state_map;
+  }
+  
+  ///@brief Die Neunummerierung der letzten Minimierung
+  const Renumbering& layout() const{
+    return renumbering;
+  }
+  
+  /** @brief Statistiken der letzten Minimierung
   
-  ///	@brief Eine Container Klasse für die Minimierung
-  struct HopcroftState{
+      Zeiten sind Wanduhrzeiten in Sekunden. Eine Runde ist bei MOORE und HASHING ein
+      Durchlauf über alle Zustände (bei MOORE zählt first_step als erste Runde), bei
+      REVUZ eine Höhenebene und bei WORKLIST ein abgearbeiteter Splitter; die Anzahl
+      der Blöcke je Runde wird bei WORKLIST nicht aufgezeichnet. Verschoben ist ein
+      Zustand, wenn er in einer Runde von seinem bisherigen Block abgetrennt wird.
+      Anforderungen zählen die Hilfsvektoren, deren Kapazität wachsen musste; bei
+      wiederholter Minimierung gleich großer Automaten ist das 0.
+  */
+  struct Stats{
+    Stats(){
+      clear();
+    }
     
-    HopcroftState(unsigned s = 0, std::vector<unsigned*> t = std::vector<unsigned*>()){
-      state = s;
-      transitions = t;
+    ///@brief Setzt alle Werte zurück
+    void clear(){
+      engine = "";
+      states = transitions = minimal_states = 0;
+      unreachable = dead = 0;
+      trim = symbol_classes = init = first_step = refine = construct = layout = total = 0;
+      sort = hash = 0;
+      rounds = 0;
+      blocks_per_round.clear();
+      states_moved = 0;
+      allocations = 0;
+      allocated_bytes = 0;
     }
     
-    /**	@brief Der "gleich"-Operator prüft ob die Zustände der beiden HopcroftStates
-							 mit den gleichen Symbolen zu den gleichen Partitionen führen
-		*/
-    bool operator==(HopcroftState& rhs){
-      if(transitions.size()!=rhs.transitions.size()) return false;
-      else{
-        for(auto it = transitions.begin(), it2 = rhs.transitions.begin();
-            it != transitions.end(); ++it, ++it2){
-          if(**it != **it2) return false;
-        }
-        return true;
-      }
+    /** @brief Schreibt die Statistiken als JSON-Objekt
+        @param o Der Ausgabestrom
+    */
+    void write_json(std::ostream& o) const{
+      o << "{\"engine\": \"" << engine << "\", \"states\": " << states << ", \"transitions\": " << transitions
+        << ", \"minimal_states\": " << minimal_states
+        << ", \"unreachable_states\": " << unreachable << ", \"dead_states\": " << dead
+        << ", \"phases\": {\"trim\": " << trim << ", \"symbol_classes\": " << symbol_classes << ", \"init\": " << init
+        << ", \"first_step\": " << first_step << ", \"refine\": " << refine
+        << ", \"construct\": " << construct << ", \"layout\": " << layout << ", \"total\": " << total << "}"
+        << ", \"sort\": " << sort << ", \"hash\": " << hash << ", \"rounds\": " << rounds
+        << ", \"blocks_per_round\": [";
+      for(std::size_t i = 0;i!=blocks_per_round.size();++i) o << (i ? ", " : "") << blocks_per_round[i];
+      o << "], \"states_moved\": " << states_moved << ", \"allocations\": " << allocations
+        << ", \"allocated_bytes\": " << allocated_bytes << "}";
     }
     
-    /**	@brief Ein "kleiner"-Operator, ähnlich dem "gleich"-Operator
-							 Zum Sortieren der Zustände nach ihren Übergängen
-		*/
-    bool operator<(HopcroftState& rhs){
-      if(transitions.size()!=rhs.transitions.size()) return transitions.size() < rhs.transitions.size();
-      else{
-        for(auto it = transitions.begin(), it2 = rhs.transitions.begin();
-            it != transitions.end(); ++it, ++it2){
-          if(**it != **it2) return **it < **it2;
+    const char* engine; ///< Das tatsächlich verwendete Verfahren
+    unsigned states; ///< Die Anzahl der Zustände vor der Minimierung
+    std::size_t transitions; ///< Die Anzahl der Übergänge vor der Minimierung
+    unsigned minimal_states; ///< Die Anzahl der Zustände danach
+    unsigned unreachable; ///< Die Anzahl entfernter unerreichbarer Zustände
+    unsigned dead; ///< Die Anzahl entfernter toter Zustände
+    double trim; ///< Entfernen unerreichbarer und toter Zustände
+    double symbol_classes; ///< Zusammenfassen und Wiederergänzen der Symbolklassen
+    double init; ///< Aufbau der Hilfsstrukturen und Anfangspartition (MOORE: mit Sortieren)
+    double first_step; ///< Die erste Runde (nur MOORE)
+    double refine; ///< Die Verfeinerung
+    double construct; ///< Neunummerierung und Aufbau des minimalen Automaten
+    double layout; ///< Neunummerierung für bessere Lokalität (set_layout)
+    double total; ///< Die gesamte Minimierung
+    double sort; ///< Davon mit Sortieren verbracht (MOORE)
+    double hash; ///< Davon mit Hashen und Gruppieren verbracht (HASHING, REVUZ)
+    unsigned rounds; ///< Die Anzahl der Runden
+    std::vector<unsigned> blocks_per_round; ///< Die Anzahl der Blöcke nach jeder Runde
+    std::size_t states_moved; ///< Die Anzahl der abgetrennten Zustände über alle Runden
+    unsigned allocations; ///< Die Anzahl der Hilfsvektoren, die neuen Speicher anfordern mussten
+    std::size_t allocated_bytes; ///< Der dabei hinzugekommene Speicher in Bytes
+  };
+  
+  ///@brief Die Statistiken der letzten Minimierung
+  const Stats& stats() const{
+    return statistics;
+  }
+  
+  ///@brief Die Anzahl der Symbolklassen bei der letzten Minimierung (0 wenn nicht zusammengefasst wurde)
+  unsigned symbol_classes() const{
+    return class_count;
+  }
+  
+  ///@brief Was vor der letzten Minimierung entfernt wurde
+  const Trimmer::Report& trimmed() const{
+    return trimmer.report();
+  }
+  
+  /** @brief Operator () zur Minimierung eines Automaten
+      @param dfa Der zu minimierende Automat
+  */
+  void operator()(DFA& dfa){
+    HOPCROFT_STATS(
+      statistics.clear();
+      statistics.states = dfa.state_count;
+      statistics.transitions = dfa.transitions.edges();
+      std::vector<std::size_t> before;
+      capacities(before);
+      Clock::time_point start = Clock::now();
+      Clock::time_point t = start;
+    )
+    class_count = 0;
+    unsigned input_states = dfa.state_count;
+    if(trim_states) trimmer(dfa);
+    HOPCROFT_STATS(
+      statistics.trim = seconds(t);
+      statistics.unreachable = trim_states ? trimmer.report().unreachable : 0;
+      statistics.dead = trim_states ? trimmer.report().dead : 0;
+      t = Clock::now();
+    )
+    bool narrowed = merge_symbols && narrow(dfa);
+    HOPCROFT_STATS(statistics.symbol_classes = seconds(t);)
+    if(engine == REVUZ || engine == AUTOMATIC){
+      HOPCROFT_STATS(statistics.engine = "revuz";)
+      if(!revuz(dfa)){
+        if(engine == REVUZ) std::cerr << "Warning: automaton is cyclic, using the worklist engine.\n";
+        HOPCROFT_STATS(statistics.engine = "worklist";)
+        worklist(dfa);
+      }
+    }
+    else if(engine == WORKLIST){
+      HOPCROFT_STATS(statistics.engine = "worklist";)
+      worklist(dfa);
+    }
+    else if(engine == HASHING){
+      HOPCROFT_STATS(statistics.engine = "hash";)
+      hashing(dfa);
+    }
+    else{
+      HOPCROFT_STATS(statistics.engine = "moore";)
+      init(dfa);
+      first_step(dfa);
+      refine(dfa);
+    }
+    HOPCROFT_STATS(t = Clock::now();)
+    normalize();
+    construct(dfa);
+    HOPCROFT_STATS(
+      statistics.construct = seconds(t);
+      t = Clock::now();
+    )
+    if(narrowed) widen(dfa);
+    HOPCROFT_STATS(
+      statistics.symbol_classes += seconds(t);
+      t = Clock::now();
+    )
+    renumbering(dfa);
+    map_states(input_states);
+    HOPCROFT_STATS(
+      statistics.layout = seconds(t);
+      statistics.total = seconds(start);
+      statistics.minimal_states = dfa.state_count;
+      std::vector<std::size_t> after;
+      capacities(after);
+      for(std::size_t i = 0;i!=after.size();++i){
+        if(after[i] > before[i]){
+          ++statistics.allocations;
+          statistics.allocated_bytes += after[i] - before[i];
         }
-        return false;
       }
+    )
+  }
+  
+  private:
+  
+  typedef std::chrono::steady_clock Clock;
+  
+  ///	@brief Die seit t vergangene Zeit in Sekunden
+  static double seconds(Clock::time_point t){
+    return std::chrono::duration<double>(Clock::now() - t).count();
+  }
+  
+  ///	@brief Die Kapazitäten aller Hilfsvektoren in Bytes, für die Zählung der Anforderungen
+  void capacities(std::vector<std::size_t>& c) const{
+    c.clear();
+    c.push_back(states.capacity() * sizeof(unsigned));
+    c.push_back(partitions.capacity() * sizeof(unsigned));
+    c.push_back(next_partitions.capacity() * sizeof(unsigned));
+    c.push_back(tails.capacity() * sizeof(unsigned));
+    c.push_back(heads.capacity() * sizeof(unsigned));
+    c.push_back(incoming.capacity() * sizeof(unsigned));
+    c.push_back(incoming_first.capacity() * sizeof(unsigned));
+    c.push_back(final_flags.capacity() / 8);
+    c.push_back(succ_first.capacity() * sizeof(unsigned));
+    c.push_back(succ_index.capacity() * sizeof(unsigned));
+    c.push_back(succ_block.capacity() * sizeof(unsigned));
+    c.push_back(hashes.capacity() * sizeof(std::size_t));
+    c.push_back(table.capacity() * sizeof(unsigned));
+    c.push_back(state_map.capacity() * sizeof(unsigned));
+  }
+  
+  /**	@brief Vergleicht zwei Zustände anhand der Partitionen, in die ihre Übergänge führen
+             (lexikographisch, kürzere Zeilen zuerst)
+      @return -1, 0 oder 1
+  */
+  int compare_successors(unsigned one, unsigned two) const{
+    unsigned size_one = succ_first[one+1] - succ_first[one];
+    unsigned size_two = succ_first[two+1] - succ_first[two];
+    if(size_one != size_two) return size_one < size_two ? -1 : 1;
+    for(unsigned i = succ_first[one], j = succ_first[two];i!=succ_first[one+1];++i,++j){
+      unsigned p = partitions[succ_index[i]];
+      unsigned q = partitions[succ_index[j]];
+      if(p != q) return p < q ? -1 : 1;
     }
-    
-    unsigned state; ///< Die Nummer des Zustandes den der  HopcroftState widerspiegelt
-    std::vector<unsigned*> transitions; ///< Die Übergänge als Pointer auf die Partitionen in die sie führen
-  };
+    return 0;
+  }
   
-  ///	@brief Funktionsobjekt zum Sortieren der HopcroftStates während der Initialisierung
+  ///	@brief Funktionsobjekt zum Sortieren der Zustände während der Initialisierung
   struct Init_compare{
     //Das Funktionsobjekt benötigt einen Pointer auf den Automaten
     //um die Signaturen der Zustände zu lesen und einen auf die
@@ -75,16 +325,16 @@ class Hopcroft{
       dfa = d;
       hop = h;
     }
-    bool operator()(HopcroftState* one, HopcroftState* two) const{
+    bool operator()(unsigned one, unsigned two) const{
       //Wenn die Partitionen unterschiedlich sind...
-      if(hop->partitions[one->state] != hop->partitions[two->state]) 
-        return hop->partitions[one->state] < hop->partitions[two->state];
+      if(hop->partitions[one] != hop->partitions[two]) 
+        return hop->partitions[one] < hop->partitions[two];
       else{
         //Wenn die Signaturen unterschiedlich sind...
-        if(dfa->signatures[one->state] != dfa->signatures[two->state])
-          return dfa->signatures[one->state] < dfa->signatures[two->state];
+        int sig = dfa->signatures.compare(one,two);
+        if(sig != 0) return sig < 0;
         //anderfalls vergleiche die Übergänge
-        else return *one < *two;
+        else return hop->compare_successors(one,two) < 0;
       }
     }
     DFA* dfa;
@@ -99,47 +349,61 @@ class Hopcroft{
     Refine_compare(Hopcroft* h){
       hop = h;
     }
-    bool operator()(HopcroftState* one, HopcroftState* two) const{
+    bool operator()(unsigned one, unsigned two) const{
       //Wenn die Partitionen ungleich sind...
-      if(hop->partitions[one->state] != hop->partitions[two->state]) 
-        return hop->partitions[one->state] < hop->partitions[two->state];
+      if(hop->partitions[one] != hop->partitions[two]) 
+        return hop->partitions[one] < hop->partitions[two];
       //andernfalls vergleiche die Übergänge...
-      else return *one < *two;
+      else return hop->compare_successors(one,two) < 0;
     }
     Hopcroft* hop;
   };
   
+  /**	@brief Schreibt die Nachfolger aller Zustände zeilenweise in ein flaches Array
+             (succ_first/succ_index). Die Vektoren behalten ihre Kapazität, so dass
+             wiederholte Minimierungen keinen neuen Speicher anfordern müssen.
+  */
+  void flatten(DFA& dfa){
+    unsigned n = dfa.transitions.size();
+    succ_first.resize(n+1);
+    succ_first[0] = 0;
+    for(unsigned i = 0;i!=n;++i) succ_first[i+1] = succ_first[i] + dfa.transitions.degree(i);
+    succ_index.resize(succ_first[n]);
+    Parallel::parallel_for(0,n,[&](int i){
+      unsigned k = succ_first[i];
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j,++k){
+        succ_index[k] = dfa.transitions.target(j);
+      }
+    });
+  }
+  
 	///	@brief init initialisiert die Datenstrukturen für die Minimierung
   void init(DFA& dfa){
+    HOPCROFT_STATS(Clock::time_point start = Clock::now();)
     //Die Vektoren erhalten gleich die richtige Größe um Reallokation vorzubeugen
-    states.resize(dfa.transitions.size(),nullptr);
-    partitions.resize(dfa.transitions.size(),0);
-    next_partitions.resize(dfa.transitions.size(),0);
+    unsigned n = dfa.transitions.size();
+    states.resize(n);
+    partitions.resize(n);
+    next_partitions.resize(n);
+    flatten(dfa);
 
     //Schleife über alle Zustände
-    int end = dfa.transitions.size();
-    concurrency::parallel_for(0,end,[&](int i){
-      //Die Übergänge des gerade zu bearbeitenden Zustandes
-      std::vector<unsigned*> current;
-      //Schleife über die jeweiligen Übergänge
-      for(auto it = dfa.transitions[i].begin();it!=dfa.transitions[i].end();++it){
-        //Fügt dem Vektor die Adresse des Zustandes hinzu in den die Übergänge führen
-        current.push_back(&partitions[it->second]);
-      }
-      //Erstellt den dazugehörigen HopcroftState
-      states[i] = new HopcroftState(i,current);
-      //anschließend wird current wieder frei gemacht
-      current.clear();
-      //und die Anfangspartition eingetragen
-      //0 für Nicht-Endzustände, 1 für Endzustände
-      if(dfa.final_states.find(i) == dfa.final_states.end()) partitions[i] = 0;
-      else partitions[i] = 1;
+    Parallel::parallel_for(0,n,[&](int i){
+      states[i] = i;
+      //Anfangspartition: 0 für Nicht-Endzustände, 1 für Endzustände
+      partitions[i] = 0;
     });
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) partitions[*it] = 1;
 
     //Anschließend werden die Zustände sortiert nach:
     //Partitionen > Signaturen > Übergänge
     //Funktionsobjekt: Init_compare
-    concurrency::parallel_sort(states.begin(),states.end(),Init_compare(&dfa, this));
+    HOPCROFT_STATS(Clock::time_point t = Clock::now();)
+    Parallel::parallel_sort(states.begin(),states.end(),Init_compare(&dfa, this));
+    HOPCROFT_STATS(
+      statistics.sort += seconds(t);
+      statistics.init = seconds(start);
+    )
     
   }
   
@@ -152,59 +416,68 @@ class Hopcroft{
     //bereits die Partitionen null und eins gesetzt. Diese werden
     //jedoch nur als Informationen für die tatsächlich Initial-
     //partitionierung benutzt.
+    HOPCROFT_STATS(Clock::time_point start = Clock::now();)
     partition_count = 0;
+    //Der erste neue Block des aktuellen alten Blocks, für die Zählung verschobener Zustände
+    unsigned block_start = 0;
     //Wir merken uns Signatur, Partition und Übergänge des Vorgängers
-    //Nachkommentar: Redundant, da wir Übergänge mit dem Operator des
-    //HopcroftStates vergleichen und uns diesen merken, aus dem man
-    //Signatur und Partition ableiten kann. Speicherersparnis wäre
-    //aber absolut minimal, deshalb und wegen der Lesbarkeit habe ich
-    //es so gelassen
-    DFA::Signature current_sig = dfa.signatures[states[0]->state];
-    unsigned current_part = partitions[states[0]->state];
-    HopcroftState* current_trans = states[0];
-    //Schleife über alle HopcroftStates
+    //(jeweils über einen Zustand, der sie besitzt)
+    unsigned current_sig = states[0];
+    unsigned current_part = partitions[states[0]];
+    unsigned current_trans = states[0];
+    //Schleife über alle Zustände
 
-    for(int i = 0;i!=states.size();++i){
-      if(current_part == partitions[states[i]->state]){
-        if(current_sig == dfa.signatures[states[i]->state]){
-          if(*current_trans == *(states[i])){
+    for(unsigned i = 0;i!=states.size();++i){
+      unsigned s = states[i];
+      if(current_part == partitions[s]){
+        if(dfa.signatures.equal(current_sig,s)){
+          if(compare_successors(current_trans,s) == 0){
             //Wenn alles übereinstimmt, weise dem Zustand die Partition
             //des Vorgängers zu
-            next_partitions[states[i]->state] = partition_count;
+            next_partitions[s] = partition_count;
           }
           else{
             //in den anderen Fällen...
             partition_count++;
-            next_partitions[states[i]->state] = partition_count;
-            current_trans = states[i];
+            next_partitions[s] = partition_count;
+            current_trans = s;
           }
         }
         else{
           //öffne eine neue Partition...
           partition_count++;
-          next_partitions[states[i]->state] = partition_count;
-          current_sig = dfa.signatures[states[i]->state];
-          current_trans = states[i];
+          next_partitions[s] = partition_count;
+          current_sig = s;
+          current_trans = s;
         }
       }
       else{
         //und merke die Attribute des Vorgängers die sich unterscheiden
         partition_count++;
-        next_partitions[states[i]->state] = partition_count;
-        current_part = partitions[states[i]->state];
-        current_sig = dfa.signatures[states[i]->state];
-        current_trans = states[i];
+        next_partitions[s] = partition_count;
+        current_part = partitions[s];
+        current_sig = s;
+        current_trans = s;
+        block_start = partition_count;
       }
+      HOPCROFT_STATS(if(next_partitions[s] != block_start) ++statistics.states_moved;)
     }
     
-    //zuletzt weisen wir die neu ermittelten Partitionen zu    
-    partitions = next_partitions;
+    //zuletzt weisen wir die neu ermittelten Partitionen zu. Da alle Einträge
+    //neu geschrieben wurden, genügt ein Tausch der Vektoren
+    partitions.swap(next_partitions);
+    HOPCROFT_STATS(
+      statistics.first_step = seconds(start);
+      statistics.rounds = 1;
+      statistics.blocks_per_round.push_back(partition_count+1);
+    )
     
   }
   
 	///	@brief Hier werden die Partitionen immer weiter verfeinert, bis keine Änderung mehr geschieht
   void refine(DFA& dfa){
     
+    HOPCROFT_STATS(Clock::time_point start = Clock::now();)
     unsigned partition_count_before = partition_count;
     do{
       
@@ -212,82 +485,580 @@ class Hopcroft{
       //Als erstes Sortieren wir die Zustände, um anschließend
       //neue Partitionen zuzuweisen
       //Im Gegensatz zu Init_compare müssen keine Signaturen verglichen werden
-      concurrency::parallel_sort(states.begin(),states.end(),Refine_compare(this));
+      HOPCROFT_STATS(Clock::time_point t = Clock::now();)
+      Parallel::parallel_sort(states.begin(),states.end(),Refine_compare(this));
+      HOPCROFT_STATS(statistics.sort += seconds(t);)
 
       partition_count_before = partition_count;
       partition_count = 0;
-      unsigned current_part = partitions[states[0]->state];
-      HopcroftState* current_trans = states[0];
+      unsigned current_part = partitions[states[0]];
+      unsigned current_trans = states[0];
+      unsigned block_start = 0;
       
-      for(int i = 0;i!=states.size();++i){
-        if(current_part == partitions[states[i]->state]){
-          if(*current_trans == *(states[i])){
-            next_partitions[states[i]->state] = partition_count;
+      for(unsigned i = 0;i!=states.size();++i){
+        unsigned s = states[i];
+        if(current_part == partitions[s]){
+          if(compare_successors(current_trans,s) == 0){
+            next_partitions[s] = partition_count;
           }
           else{
             partition_count++;
-            next_partitions[states[i]->state] = partition_count;
-            current_trans = states[i];
+            next_partitions[s] = partition_count;
+            current_trans = s;
           }
         }
         else{
           partition_count++;
-          next_partitions[states[i]->state] = partition_count;
-          current_trans = states[i];
-          current_part = partitions[states[i]->state];
+          next_partitions[s] = partition_count;
+          current_trans = s;
+          current_part = partitions[s];
+          block_start = partition_count;
         }
+        HOPCROFT_STATS(if(next_partitions[s] != block_start) ++statistics.states_moved;)
       }
 
-      partitions = next_partitions;
+      partitions.swap(next_partitions);
+      HOPCROFT_STATS(
+        ++statistics.rounds;
+        statistics.blocks_per_round.push_back(partition_count+1);
+      )
       
     }while(partition_count != partition_count_before);
+    HOPCROFT_STATS(statistics.refine = seconds(start);)
     
   }
   
-	///	@brief Konstruktion des minimalen DFA und Weitergabe an die DFA-Instanz
-  void construct(DFA& dfa){
-    //Die Container für den neuen minimalen DFA
-    unsigned new_start_state;
-    unsigned new_state_count = partition_count+1;
-    unsigned new_transition_count = 0;
+  /**	@brief Verfeinerung mit Splitter-Worklist nach Valmari und Lehtinen
+  
+             Die Zustände (Blöcke) und die Übergänge (Cords, anfangs nach Symbolen
+             getrennt) werden jeweils als verfeinerbare Partition gehalten. Jede Cord
+             teilt die Blöcke nach den Quellen ihrer Übergänge, jeder neue Block teilt
+             die Cords nach den Übergängen, die in ihn führen. Da ein geteilter Block
+             nur mit seiner kleineren Hälfte neu eingereiht wird, wird jeder Zustand
+             höchstens O(log n) mal angefasst. Fehlende Übergänge sind erlaubt.
+  */
+  void worklist(DFA& dfa){
+    HOPCROFT_STATS(Clock::time_point start = Clock::now();)
+    unsigned n = dfa.transitions.size();
     
-    std::vector<DFA::Signature> new_signatures;
-    new_signatures.resize(new_state_count,DFA::Signature());
+    //Die Übergänge werden durchnummeriert und nach Symbolen sortiert
+    std::vector<unsigned> label_first(257,0);
+    for(unsigned i = 0;i!=n;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        ++label_first[(unsigned char)dfa.transitions.symbol(j)+1];
+      }
+    }
+    for(unsigned c = 0;c!=256;++c) label_first[c+1] += label_first[c];
+    unsigned m = label_first[256];
+    tails.resize(m);
+    heads.resize(m);
+    std::vector<unsigned> label_next(label_first.begin(),label_first.end()-1);
+    for(unsigned i = 0;i!=n;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        unsigned e = label_next[(unsigned char)dfa.transitions.symbol(j)]++;
+        tails[e] = i;
+        heads[e] = dfa.transitions.target(j);
+      }
+    }
     
-    std::vector<std::map<char,unsigned>> new_transitions;
-    new_transitions.resize(new_state_count,std::map<char,unsigned>());
+    //Die eingehenden Übergänge je Zustand
+    incoming_first.assign(n+1,0);
+    for(unsigned e = 0;e!=m;++e) ++incoming_first[heads[e]+1];
+    for(unsigned i = 0;i!=n;++i) incoming_first[i+1] += incoming_first[i];
+    incoming.resize(m);
+    std::vector<unsigned> incoming_next(incoming_first.begin(),incoming_first.end()-1);
+    for(unsigned e = 0;e!=m;++e) incoming[incoming_next[heads[e]]++] = e;
     
-    std::unordered_set<unsigned> new_final_states;
+    //Anfangspartition der Zustände: Nicht-Endzustände und Endzustände
+    blocks.init(n);
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) blocks.mark(*it);
+    blocks.split();
     
-    for(unsigned i = 0;i!=partitions.size();++i){
-      if(i == dfa.start_state){
-        new_start_state = partitions[i];
+    //Anfangspartition der Übergänge: eine Cord je Symbol
+    cords.init(m);
+    for(unsigned c = 0;c!=256;++c){
+      for(unsigned e = label_first[c];e!=label_first[c+1];++e) cords.mark(e);
+      cords.split();
+    }
+    
+    HOPCROFT_STATS(
+      statistics.init += seconds(start);
+      start = Clock::now();
+    )
+    
+    //Block 0 (der größere Teil) muss nicht als Splitter verwendet werden
+    unsigned b = 1, c = 0;
+    while(c < cords.size()){
+      for(unsigned i = cords.begin(c);i!=cords.end(c);++i) blocks.mark(tails[cords.element(i)]);
+      HOPCROFT_STATS(unsigned split_from = blocks.size();)
+      blocks.split();
+      HOPCROFT_STATS(
+        ++statistics.rounds;
+        for(unsigned k = split_from;k!=blocks.size();++k) statistics.states_moved += blocks.end(k) - blocks.begin(k);
+      )
+      ++c;
+      while(b < blocks.size()){
+        for(unsigned i = blocks.begin(b);i!=blocks.end(b);++i){
+          unsigned s = blocks.element(i);
+          for(unsigned j = incoming_first[s];j!=incoming_first[s+1];++j) cords.mark(incoming[j]);
+        }
+        cords.split();
+        ++b;
       }
-      if(dfa.final_states.find(i)!=dfa.final_states.end()){
-        new_final_states.insert(partitions[i]);
-        new_signatures[partitions[i]] += 63;
+    }
+    
+    partitions.resize(n);
+    for(unsigned i = 0;i!=n;++i) partitions[i] = blocks.set(i);
+    partition_count = blocks.size() ? blocks.size()-1 : 0;
+    HOPCROFT_STATS(statistics.refine = seconds(start);)
+  }
+  
+  /**	@brief Hashfunktion für Revuz: Endzustandsmarkierung, Symbole und Partitionen der Ziele
+  
+             Wie bei MOORE werden Zustände über die Partitionen verglichen,
+             in die ihre Übergänge führen. Da von den Blättern aufwärts gearbeitet wird,
+             sind diese Partitionen beim Vergleich bereits endgültig.
+  */
+  struct Revuz_hash{
+    Revuz_hash(DFA* d,Hopcroft* h){
+      dfa = d;
+      hop = h;
+    }
+    std::size_t operator()(unsigned s) const{
+      std::size_t h = hop->final_flags[s] ? 0x9e3779b97f4a7c15ULL : 0;
+      for(unsigned j = dfa->transitions.begin(s);j!=dfa->transitions.end(s);++j){
+        h = (h ^ (unsigned char)dfa->transitions.symbol(j)) * 0x100000001b3ULL;
+        h = (h ^ hop->partitions[dfa->transitions.target(j)]) * 0x100000001b3ULL;
       }
-      for(auto it = dfa.transitions[i].begin();it!=dfa.transitions[i].end();++it){
-        if(new_transitions[partitions[i]].find(it->first)==new_transitions[partitions[i]].end()){
-          new_transitions[partitions[i]][it->first] = partitions[it->second];
-          new_transition_count++;
-          new_signatures[partitions[i]] += dfa.alphabet[it->first];
+      return h ^ (h >> 29);
+    }
+    DFA* dfa;
+    Hopcroft* hop;
+  };
+  
+  ///	@brief Gleichheit für Revuz, passend zu Revuz_hash
+  struct Revuz_equal{
+    Revuz_equal(DFA* d,Hopcroft* h){
+      dfa = d;
+      hop = h;
+    }
+    bool operator()(unsigned one, unsigned two) const{
+      if(hop->final_flags[one] != hop->final_flags[two]) return false;
+      if(dfa->transitions.degree(one) != dfa->transitions.degree(two)) return false;
+      for(unsigned i = dfa->transitions.begin(one), j = dfa->transitions.begin(two);
+          i!=dfa->transitions.end(one);++i,++j){
+        if(dfa->transitions.symbol(i) != dfa->transitions.symbol(j)) return false;
+        if(hop->partitions[dfa->transitions.target(i)] != hop->partitions[dfa->transitions.target(j)]) return false;
+      }
+      return true;
+    }
+    DFA* dfa;
+    Hopcroft* hop;
+  };
+  
+  /**	@brief Minimierung azyklischer Automaten nach Revuz
+  
+             Die Höhe eines Zustands ist die Länge des längsten Pfades zu einem Zustand
+             ohne Übergänge. Äquivalente Zustände haben dieselbe Höhe, daher werden die
+             Zustände nach Höhe in Eimer sortiert und Ebene für Ebene von unten über
+             eine Hashtabelle ihrer Signaturen zusammengefasst. Jeder Zustand wird genau
+             einmal angefasst, es gibt keine Runden.
+      @return false wenn der Automat einen Zyklus hat; die Partitionen sind dann unbestimmt
+  */
+  bool revuz(DFA& dfa){
+    HOPCROFT_STATS(Clock::time_point start = Clock::now();)
+    unsigned n = dfa.transitions.size();
+    
+    //Die Vorgänger jedes Zustands (einmal je Übergang)
+    incoming_first.assign(n+1,0);
+    for(unsigned i = 0;i!=n;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        ++incoming_first[dfa.transitions.target(j)+1];
+      }
+    }
+    for(unsigned i = 0;i!=n;++i) incoming_first[i+1] += incoming_first[i];
+    incoming.resize(incoming_first[n]);
+    std::vector<unsigned> incoming_next(incoming_first.begin(),incoming_first.end()-1);
+    for(unsigned i = 0;i!=n;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        incoming[incoming_next[dfa.transitions.target(j)]++] = i;
+      }
+    }
+    
+    //Berechnung der Höhen in topologischer Reihenfolge von den Blättern aus (Kahn).
+    //Werden dabei nicht alle Zustände erreicht, gibt es einen Zyklus.
+    std::vector<unsigned> height(n,0);
+    std::vector<unsigned> pending(n);
+    std::vector<unsigned> queue;
+    queue.reserve(n);
+    for(unsigned i = 0;i!=n;++i){
+      pending[i] = dfa.transitions.degree(i);
+      if(!pending[i]) queue.push_back(i);
+    }
+    unsigned max_height = 0;
+    for(unsigned k = 0;k!=queue.size();++k){
+      unsigned s = queue[k];
+      for(unsigned j = incoming_first[s];j!=incoming_first[s+1];++j){
+        unsigned p = incoming[j];
+        if(height[p] < height[s]+1) height[p] = height[s]+1;
+        if(!--pending[p]){
+          queue.push_back(p);
+          if(height[p] > max_height) max_height = height[p];
+        }
+      }
+    }
+    if(queue.size() != n){
+      HOPCROFT_STATS(statistics.init += seconds(start);)
+      return false;
+    }
+    
+    //Eimer nach Höhe (Counting Sort)
+    std::vector<unsigned> level_first(max_height+2,0);
+    for(unsigned i = 0;i!=n;++i) ++level_first[height[i]+1];
+    for(unsigned h = 0;h<=max_height;++h) level_first[h+1] += level_first[h];
+    std::vector<unsigned> level_next(level_first.begin(),level_first.end()-1);
+    for(unsigned i = 0;i!=n;++i) queue[level_next[height[i]]++] = i;
+    
+    final_flags.assign(n,false);
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) final_flags[*it] = true;
+    partitions.resize(n);
+    
+    HOPCROFT_STATS(
+      statistics.init += seconds(start);
+      start = Clock::now();
+    )
+    
+    //Ebene für Ebene: Zustände mit gleicher Signatur erhalten dieselbe Partition
+    std::unordered_set<unsigned,Revuz_hash,Revuz_equal> level(1024,Revuz_hash(&dfa,this),Revuz_equal(&dfa,this));
+    unsigned count = 0;
+    for(unsigned h = 0;h<=max_height;++h){
+      level.clear();
+      for(unsigned k = level_first[h];k!=level_first[h+1];++k){
+        unsigned s = queue[k];
+        auto it = level.find(s);
+        if(it != level.end()){
+          partitions[s] = partitions[*it];
+        }
+        else{
+          partitions[s] = count++;
+          level.insert(s);
         }
       }
+      HOPCROFT_STATS(
+        ++statistics.rounds;
+        statistics.blocks_per_round.push_back(count);
+      )
+    }
+    partition_count = count ? count-1 : 0;
+    HOPCROFT_STATS(statistics.refine = statistics.hash = seconds(start);)
+    return true;
+  }
+  
+  /**	@brief Verfeinerung in Runden über Hashing statt Sortieren
+  
+             Die Nachfolger aller Zustände werden einmal in ein flaches Array geschrieben.
+             In jeder Runde werden die Partitionen der Nachfolger daraus gesammelt (gather),
+             die Signaturen (Partition, Partitionen der Nachfolger) parallel gehasht und
+             die Zustände über eine Hashtabelle mit offener Adressierung neu nummeriert.
+             Bei gleichem Hashwert werden die Signaturen vollständig verglichen.
+  */
+  void hashing(DFA& dfa){
+    HOPCROFT_STATS(Clock::time_point start = Clock::now();)
+    unsigned n = dfa.transitions.size();
+    
+    //Flache Nachfolgerliste je Zustand, für die Anfangspartition zunächst mit den Symbolen
+    flatten(dfa);
+    unsigned m = succ_first[n];
+    succ_block.resize(m);
+    Parallel::parallel_for(0,n,[&](int i){
+      unsigned k = succ_first[i];
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j,++k){
+        succ_block[k] = (unsigned char)dfa.transitions.symbol(j);
+      }
+    });
+    
+    //Anfangspartition: Endzustandsmarkierung und Symbolmenge
+    next_partitions.assign(n,0);
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) next_partitions[*it] = 1;
+    partitions.resize(n);
+    unsigned count = group(next_partitions,partitions);
+    HOPCROFT_STATS(
+      statistics.init = seconds(start);
+      start = Clock::now();
+      std::vector<unsigned> first_block;
+    )
+    
+    unsigned count_before;
+    do{
+      count_before = count;
+      //Sammeln der Partitionen der Nachfolger, in Stücken parallel
+      int chunks = (m + 65535) / 65536;
+      Parallel::parallel_for(0,chunks,[&](int c){
+        unsigned first = c * 65536u;
+        unsigned last = std::min(first + 65536u,m);
+        gather(&succ_index[first],&partitions[0],&succ_block[first],last - first);
+      },1);
+      HOPCROFT_STATS(Clock::time_point t = Clock::now();)
+      count = group(partitions,next_partitions);
+      HOPCROFT_STATS(
+        statistics.hash += seconds(t);
+        ++statistics.rounds;
+        statistics.blocks_per_round.push_back(count);
+        //Verschoben sind die Zustände, die nicht im Block des ersten Zustands ihres alten Blocks landen
+        first_block.assign(count_before,Transitions::NONE);
+        for(unsigned q = 0;q!=n;++q){
+          if(first_block[partitions[q]] == Transitions::NONE) first_block[partitions[q]] = next_partitions[q];
+          else if(first_block[partitions[q]] != next_partitions[q]) ++statistics.states_moved;
+        }
+      )
+      partitions.swap(next_partitions);
+    }while(count != count_before);
+    
+    partition_count = count ? count-1 : 0;
+    HOPCROFT_STATS(statistics.refine = seconds(start);)
+  }
+  
+  /**	@brief Sammelt table[index[k]] für k aus [0,n), mit AVX2 acht Einträge auf einmal
+  */
+  static void gather(const unsigned* index, const unsigned* table, unsigned* out, unsigned n){
+    unsigned k = 0;
+#ifdef __AVX2__
+    for(;k+8<=n;k+=8){
+      __m256i idx = _mm256_loadu_si256((const __m256i*)(index+k));
+      _mm256_storeu_si256((__m256i*)(out+k),_mm256_i32gather_epi32((const int*)table,idx,4));
     }
+#endif
+    for(;k!=n;++k) out[k] = table[index[k]];
+  }
+  
+  /**	@brief Nummeriert die Zustände nach ihrer Signatur (head[q], succ_block des Zustands) neu
+      @param head der erste Wert der Signatur je Zustand
+      @param result die neuen Partitionen
+      @return die Anzahl der Partitionen
+  */
+  unsigned group(const std::vector<unsigned>& head, std::vector<unsigned>& result){
+    unsigned n = head.size();
+    hashes.resize(n);
+    Parallel::parallel_for(0,n,[&](int q){
+      std::size_t h = (head[q] + 1) * 0x9e3779b97f4a7c15ULL;
+      for(unsigned k = succ_first[q];k!=succ_first[q+1];++k){
+        h = (h ^ succ_block[k]) * 0x100000001b3ULL;
+      }
+      hashes[q] = h ^ (h >> 32);
+    });
     
-    //Zuweisung des neuen minimalen DFA
-    dfa.signatures = new_signatures;
-    dfa.transitions = new_transitions;
+    //Hashtabelle mit offener Adressierung, mindestens doppelt so groß wie n
+    std::size_t size = 16;
+    while(size < 2 * (std::size_t)n) size *= 2;
+    table.assign(size,Transitions::NONE);
+    unsigned count = 0;
+    for(unsigned q = 0;q!=n;++q){
+      std::size_t slot = hashes[q] & (size - 1);
+      while(true){
+        unsigned r = table[slot];
+        if(r == Transitions::NONE){
+          table[slot] = q;
+          result[q] = count++;
+          break;
+        }
+        if(hashes[r] == hashes[q] && same_signature(head,q,r)){
+          result[q] = result[r];
+          break;
+        }
+        slot = (slot + 1) & (size - 1);
+      }
+    }
+    return count;
+  }
+  
+  ///	@brief Vollständiger Vergleich zweier Signaturen bei gleichem Hashwert
+  bool same_signature(const std::vector<unsigned>& head, unsigned one, unsigned two) const{
+    if(head[one] != head[two]) return false;
+    if(succ_first[one+1] - succ_first[one] != succ_first[two+1] - succ_first[two]) return false;
+    for(unsigned i = succ_first[one], j = succ_first[two];i!=succ_first[one+1];++i,++j){
+      if(succ_block[i] != succ_block[j]) return false;
+    }
+    return true;
+  }
+  
+  /**	@brief Fasst gleichwertige Symbole zu Klassen zusammen und entfernt aus allen Zeilen
+             die Übergänge, deren Symbol nicht Vertreter seiner Klasse ist
+  
+             Anfangs bilden alle Symbole des Alphabets eine Klasse. Jede Zeile teilt die
+             Klassen nach den Zielen ihrer Übergänge: die Symbole einer Klasse, die hier
+             zum selben Ziel führen, werden abgetrennt, wenn sie nicht die ganze Klasse sind.
+             Die Signaturen bleiben unverändert, da die Symbole einer Klasse immer gemeinsam
+             auftreten.
+      @return false wenn es nichts zusammenzufassen gibt
+  */
+  bool narrow(DFA& dfa){
+    unsigned n = dfa.transitions.size();
+    std::vector<unsigned> symbol_class(256,Transitions::NONE);
+    std::vector<unsigned> class_size(1,dfa.alphabet.size());
+    for(unsigned i = 0;i!=dfa.alphabet.size();++i) symbol_class[(unsigned char)dfa.alphabet.symbol(i)] = 0;
+    
+    //(Klasse, Ziel, Symbol) je Übergang einer Zeile
+    std::vector<std::pair<std::pair<unsigned,unsigned>,unsigned char> > row;
+    for(unsigned i = 0;i!=n;++i){
+      row.clear();
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        unsigned char c = dfa.transitions.symbol(j);
+        row.push_back(std::make_pair(std::make_pair(symbol_class[c],dfa.transitions.target(j)),c));
+      }
+      std::sort(row.begin(),row.end());
+      for(unsigned k = 0;k!=row.size();){
+        unsigned l = k;
+        while(l != row.size() && row[l].first == row[k].first) ++l;
+        unsigned old_class = row[k].first.first;
+        if(l - k != class_size[old_class]){
+          class_size[old_class] -= l - k;
+          for(unsigned r = k;r!=l;++r) symbol_class[row[r].second] = class_size.size();
+          class_size.push_back(l - k);
+        }
+        k = l;
+      }
+    }
+    class_count = class_size.size();
+    if(class_count == dfa.alphabet.size()){
+      class_count = 0;
+      return false;
+    }
+    
+    //Vertreter ist das kleinste Symbol einer Klasse, die übrigen werden je Vertreter gemerkt
+    std::vector<int> representative(class_count,-1);
+    class_members.assign(256,std::string());
+    for(unsigned c = 0;c!=256;++c){
+      if(symbol_class[c] == Transitions::NONE) continue;
+      if(representative[symbol_class[c]] < 0) representative[symbol_class[c]] = c;
+      else class_members[representative[symbol_class[c]]] += (char)c;
+    }
+    std::vector<Transitions::Arc> arcs;
+    arcs.reserve(dfa.transitions.edges());
+    for(unsigned i = 0;i!=n;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        Transitions::Arc arc;
+        arc.source = i;
+        arc.target = dfa.transitions.target(j);
+        arc.symbol = dfa.transitions.symbol(j);
+        if(representative[symbol_class[(unsigned char)arc.symbol]] == (unsigned char)arc.symbol) arcs.push_back(arc);
+      }
+    }
+    dfa.transitions.assign(n,arcs);
+    dfa.transition_count = dfa.transitions.edges();
+    return true;
+  }
+  
+  ///	@brief Ergänzt nach der Minimierung die Übergänge der übrigen Symbole jeder Klasse
+  void widen(DFA& dfa){
+    unsigned n = dfa.transitions.size();
+    //Jede Zeile wird gesammelt und einmal sortiert, assign() muss dann nichts mehr verschieben
+    std::size_t count = 0;
+    for(unsigned i = 0;i!=n;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        count += 1 + class_members[(unsigned char)dfa.transitions.symbol(j)].size();
+      }
+    }
+    std::vector<Transitions::Arc> arcs;
+    arcs.reserve(count);
+    std::vector<std::pair<unsigned char,unsigned> > row;
+    for(unsigned i = 0;i!=n;++i){
+      row.clear();
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        unsigned char c = dfa.transitions.symbol(j);
+        unsigned t = dfa.transitions.target(j);
+        row.push_back(std::make_pair(c,t));
+        const std::string& members = class_members[c];
+        for(unsigned k = 0;k!=members.size();++k) row.push_back(std::make_pair((unsigned char)members[k],t));
+      }
+      std::sort(row.begin(),row.end());
+      for(unsigned k = 0;k!=row.size();++k){
+        Transitions::Arc arc;
+        arc.source = i;
+        arc.target = row[k].second;
+        arc.symbol = row[k].first;
+        arcs.push_back(arc);
+      }
+    }
+    dfa.transitions.assign(n,arcs);
+    dfa.transition_count = dfa.transitions.edges();
+  }
+  
+  /**	@brief Nummeriert die Partitionen in der Reihenfolge ihres ersten Zustands,
+             damit alle Verfahren denselben Automaten erzeugen
+  */
+  void normalize(){
+    std::vector<unsigned> number(partition_count+1,Transitions::NONE);
+    unsigned next = 0;
+    for(unsigned i = 0;i!=partitions.size();++i){
+      if(number[partitions[i]] == Transitions::NONE) number[partitions[i]] = next++;
+      partitions[i] = number[partitions[i]];
+    }
+  }
+  
+	///	@brief Konstruktion des minimalen DFA und Weitergabe an die DFA-Instanz
+  void construct(DFA& dfa){
+    unsigned new_state_count = partition_count+1;
+    
+    //Alle Zustände einer Partition haben die gleichen Übergänge (auf Partitionsebene),
+    //daher genügt je Partition ein Repräsentant
+    std::vector<unsigned> representatives(new_state_count,Transitions::NONE);
+    std::size_t new_transition_count = 0;
+    for(unsigned i = 0;i!=partitions.size();++i){
+      if(representatives[partitions[i]]!=Transitions::NONE) continue;
+      representatives[partitions[i]] = i;
+      new_transition_count += dfa.transitions.degree(i);
+    }
+    
+    //Die Zeilen werden in einem Durchlauf angehängt, die Symbole sind bereits sortiert
+    Transitions new_transitions;
+    new_transitions.reserve(new_state_count,new_transition_count);
+    for(unsigned p = 0;p!=new_state_count;++p){
+      unsigned r = representatives[p];
+      new_transitions.push_back();
+      for(unsigned j = dfa.transitions.begin(r);j!=dfa.transitions.end(r);++j){
+        new_transitions.append(dfa.transitions.symbol(j),partitions[dfa.transitions.target(j)]);
+      }
+    }
+    
+    //Endzustände über die alten Endzustände statt über eine Suche je Partition,
+    //eingefügt in aufsteigender Reihenfolge (bestimmt die Reihenfolge in draw())
+    std::vector<bool> final_partitions(new_state_count,false);
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) final_partitions[partitions[*it]] = true;
+    std::unordered_set<unsigned> new_final_states;
+    for(unsigned p = 0;p!=new_state_count;++p){
+      if(final_partitions[p]) new_final_states.insert(p);
+    }
+    
+    //Übergabe an den DFA ohne Kopien, die alten Container werden dabei freigegeben
+    dfa.signatures = dfa.signatures.select(representatives);
+    dfa.transitions = std::move(new_transitions);
     dfa.state_count = new_state_count;
     dfa.transition_count = new_transition_count;
-    dfa.final_states = new_final_states;
-    dfa.start_state = new_start_state;
+    dfa.final_states = std::move(new_final_states);
+    dfa.start_state = partitions[dfa.start_state];
+  }
+  
+  //Setzt die Zuordnung der Eingabezustände zu den minimalen Zuständen aus
+  //Trimmen, Partition und Neunummerierung zusammen
+  void map_states(unsigned n){
+    state_map.resize(n);
+    const std::vector<unsigned>& trimmed_to = trimmer.mapping();
+    const std::vector<unsigned>& renumbered_to = renumbering.mapping();
+    for(unsigned s = 0;s!=n;++s){
+      unsigned t = trim_states ? trimmed_to[s] : s;
+      if(t == Transitions::NONE){
+        state_map[s] = Transitions::NONE;
+        continue;
+      }
+      t = partitions[t];
+      state_map[s] = renumbered_to.empty() ? t : renumbered_to[t];
+    }
   }
   
-  //Um beim späteren Sortieren nicht zu große Datenmengen bewegen
-  //zu müssen habe ich mich hier für Pointer entschieden
-  std::vector<HopcroftState*> states; ///< Die Zustände als HopcroftStates.
+  //Beim Sortieren werden nur 4-Byte-Indizes bewegt, die Nachfolger liegen
+  //getrennt in succ_first/succ_index (Structure of Arrays). Alle Vektoren
+  //sind Member und behalten ihre Kapazität über mehrere Aufrufe hinweg.
+  std::vector<unsigned> states; ///< Die Zustandsnummern in Sortierreihenfolge (MOORE)
   
   std::vector<unsigned> partitions;///< Die aktuelle Partitionen in denen sich die jeweiligen Zustände befinden
 
@@ -295,4 +1066,28 @@ class Hopcroft{
   
   unsigned partition_count; ///< Zähler der Partitionen
   
+  Engine engine; ///< Das Verfahren zur Verfeinerung
+  
+  bool merge_symbols; ///< true wenn gleichwertige Symbole zusammengefasst werden
+  bool trim_states; ///< true wenn unerreichbare und tote Zustände vorher entfernt werden
+  Trimmer trimmer; ///< Entfernt unerreichbare und tote Zustände
+  Renumbering renumbering; ///< Nummeriert die minimalen Zustände neu (set_layout)
+  std::vector<unsigned> state_map; ///< Der minimale Zustand je Eingabezustand (partition())
+  unsigned class_count; ///< Die Anzahl der Symbolklassen bei der letzten Minimierung
+  std::vector<std::string> class_members; ///< Die übrigen Symbole der Klasse je Vertreter
+  Stats statistics; ///< Die Statistiken der letzten Minimierung
+  
+  RefinablePartition blocks; ///< Die Blöcke der Zustände (WORKLIST)
+  RefinablePartition cords; ///< Die Übergänge, getrennt nach Symbol und Zielblock (WORKLIST)
+  std::vector<unsigned> tails; ///< Die Quellzustände der durchnummerierten Übergänge (WORKLIST)
+  std::vector<unsigned> heads; ///< Die Zielzustände der durchnummerierten Übergänge (WORKLIST)
+  std::vector<unsigned> incoming; ///< Die eingehenden Übergänge bzw. Vorgänger, nach Zielzustand gruppiert (WORKLIST, REVUZ)
+  std::vector<unsigned> incoming_first; ///< Der Anfang der eingehenden Übergänge je Zustand (WORKLIST, REVUZ)
+  std::vector<bool> final_flags; ///< Endzustandsmarkierungen aller Zustände (REVUZ)
+  std::vector<unsigned> succ_first; ///< Der Anfang der Nachfolger je Zustand in succ_index (MOORE, HASHING)
+  std::vector<unsigned> succ_index; ///< Die Nachfolger aller Zustände, zeilenweise (MOORE, HASHING)
+  std::vector<unsigned> succ_block; ///< Die Partitionen der Nachfolger in der aktuellen Runde (HASHING)
+  std::vector<std::size_t> hashes; ///< Die Hashwerte der Signaturen (HASHING)
+  std::vector<unsigned> table; ///< Die Hashtabelle zum Neunummerieren (HASHING)
+  
 };
\ No newline at end of file
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// mapped_file.hpp
+// Klasse für das Hopcroft Projekt
+// Nur-Lese-Zugriff auf Dateien über mmap
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __MAPPED_FILE_HPP__
+#define __MAPPED_FILE_HPP__
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <cstddef>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/** @brief Eine schreibgeschützt in den Speicher abgebildete Datei
+
+    Unter POSIX wird die Datei mit mmap eingeblendet, so dass nichts kopiert wird
+    und mehrere Prozesse sich die Seiten teilen. Unter Windows wird die Datei
+    ersatzweise vollständig in einen Puffer gelesen.
+*/
+class MappedFile{
+
+public:
+
+///@brief Der Konstruktor der Klasse
+MappedFile(){
+  bytes = nullptr;
+  length = 0;
+  mapped = false;
+}
+
+///@brief Der Destruktor gibt die Abbildung wieder frei
+~MappedFile(){
+  close();
+}
+
+/** @brief Bildet eine Datei in den Speicher ab
+    @param filename der Name der Datei
+    @return false wenn die Datei nicht geöffnet werden konnte
+*/
+bool open(const std::string& filename){
+  close();
+#ifndef _WIN32
+  int fd = ::open(filename.c_str(),O_RDONLY);
+  if(fd < 0) return false;
+  struct stat st;
+  if(fstat(fd,&st) != 0){
+    ::close(fd);
+    return false;
+  }
+  length = st.st_size;
+  if(length){
+    void* p = mmap(nullptr,length,PROT_READ,MAP_SHARED,fd,0);
+    if(p == MAP_FAILED){
+      ::close(fd);
+      length = 0;
+      return false;
+    }
+    madvise(p,length,MADV_SEQUENTIAL);
+    bytes = static_cast<const char*>(p);
+    mapped = true;
+  }
+  ::close(fd);
+  return true;
+#else
+  std::ifstream in(filename.c_str(),std::ios::binary);
+  if(!in) return false;
+  buffer.assign(std::istreambuf_iterator<char>(in),std::istreambuf_iterator<char>());
+  bytes = buffer.data();
+  length = buffer.size();
+  return true;
+#endif
+}
+
+///@brief Gibt die Abbildung frei
+void close(){
+#ifndef _WIN32
+  if(mapped) munmap(const_cast<char*>(bytes),length);
+#endif
+  buffer.clear();
+  bytes = nullptr;
+  length = 0;
+  mapped = false;
+}
+
+///@brief Der Anfang der Daten
+const char* data() const{
+  return bytes;
+}
+
+///@brief Die Größe der Datei in Bytes
+std::size_t size() const{
+  return length;
+}
+
+private:
+
+MappedFile(const MappedFile&);
+MappedFile& operator=(const MappedFile&);
+
+const char* bytes; ///< Der Anfang der Daten
+std::size_t length; ///< Die Größe in Bytes
+bool mapped; ///< true wenn die Daten mit mmap abgebildet sind
+std::vector<char> buffer; ///< Der Puffer, falls nicht abgebildet werden kann
+
+};
+
+#endif
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+// nfa.hpp
+// Klasse für das Hopcroft Projekt
+// Nichtdeterministische Automaten im AT&T-Format (tfsm)
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NFA_HPP__
+#define __NFA_HPP__
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "tfsm.hpp"
+#include "mapped_file.hpp"
+
+/** @brief Klasse zur Repräsentation nichtdeterministischer endlicher Automaten
+
+    Ein Zustand darf mehrere Übergänge mit demselben Symbol haben. Übergänge mit
+    dem Eingabesymbol <eps> sind Epsilon-Übergänge. Die Übergänge liegen nach
+    Quelle, Symbol (als unsigned char) und Ziel sortiert in einem flachen Array,
+    die Epsilon-Übergänge getrennt davon; first und epsilon_first geben je Zustand
+    den Anfang seiner Zeile an.
+
+    Das Dateiformat ist dasselbe wie für DFAs (siehe TfsmReader): der Startzustand
+    ist die Quelle des ersten Übergangs, Symbole aus mehreren Bytes werden zu
+    Ketten über neue Zwischenzustände.
+*/
+class NFA{
+
+  //Die Potenzmengenkonstruktion liest die Zeilen direkt
+  friend class SubsetConstruction;
+
+  public:
+
+  ///@brief Der Konstruktor der Klasse, ein Startzustand ohne Übergänge
+  NFA(){
+    start_state = 0;
+    state_count = 1;
+    first.assign(2,0);
+    epsilon_first.assign(2,0);
+    final.assign(1,false);
+    malformed = 0;
+  }
+
+  /** @brief Liest einen Automaten aus einer Datei im AT&T-Format
+      @param filename Der Name der Datei
+      @return false wenn die Datei nicht geöffnet werden konnte
+  */
+  bool read(const std::string& filename){
+    MappedFile file;
+    if(!file.open(filename)) return false;
+    TfsmReader::Chunk chunk;
+    TfsmReader::parse(file.data(),file.data()+file.size(),chunk);
+    malformed = chunk.malformed;
+    state_count = std::max(chunk.states,1u);
+    start_state = chunk.has_start ? chunk.start : (chunk.finals.empty() ? 0 : chunk.finals.front());
+
+    std::vector<Transitions::Arc> epsilons;
+    for(auto it = chunk.long_arcs.begin();it!=chunk.long_arcs.end();++it){
+      Transitions::Arc arc;
+      arc.source = it->source;
+      arc.target = it->target;
+      if(it->label == "<eps>"){
+        arc.symbol = 0;
+        epsilons.push_back(arc);
+        continue;
+      }
+      //Ketten brauchen keine gemeinsamen Zwischenzustände, der Automat ist ohnehin nichtdeterministisch
+      for(std::size_t k = 0;k+1<it->label.size();++k){
+        arc.target = state_count++;
+        arc.symbol = it->label[k];
+        chunk.arcs.push_back(arc);
+        arc.source = arc.target;
+      }
+      arc.target = it->target;
+      arc.symbol = it->label[it->label.size()-1];
+      chunk.arcs.push_back(arc);
+    }
+    arcs.swap(chunk.arcs);
+    rows(arcs,first);
+    rows(epsilons,epsilon_first);
+    epsilon_targets.resize(epsilons.size());
+    for(std::size_t i = 0;i!=epsilons.size();++i) epsilon_targets[i] = epsilons[i].target;
+    final.assign(state_count,false);
+    for(auto it = chunk.finals.begin();it!=chunk.finals.end();++it) final[*it] = true;
+
+    if(malformed) std::cerr << "Warning: " << malformed << " malformed lines in " << filename << " were skipped.\n";
+    return true;
+  }
+
+  ///@brief Die Anzahl der Zustände
+  unsigned number_of_states() const{
+    return state_count;
+  }
+
+  ///@brief Die Anzahl der Übergänge ohne Epsilon-Übergänge
+  std::size_t number_of_transitions() const{
+    return arcs.size();
+  }
+
+  ///@brief Die Anzahl der Epsilon-Übergänge
+  std::size_t number_of_epsilons() const{
+    return epsilon_targets.size();
+  }
+
+  ///@brief Die Anzahl übersprungener fehlerhafter Zeilen beim letzten Einlesen
+  std::size_t malformed_lines() const{
+    return malformed;
+  }
+
+  private:
+
+  //Sortiert Übergänge nach Quelle, Symbol und Ziel, entfernt doppelte und setzt den Zeilenanfang je Zustand
+  void rows(std::vector<Transitions::Arc>& a, std::vector<unsigned>& begin) const{
+    std::sort(a.begin(),a.end(),[](const Transitions::Arc& x, const Transitions::Arc& y){
+      if(x.source != y.source) return x.source < y.source;
+      if(x.symbol != y.symbol) return (unsigned char)x.symbol < (unsigned char)y.symbol;
+      return x.target < y.target;
+    });
+    a.erase(std::unique(a.begin(),a.end(),[](const Transitions::Arc& x, const Transitions::Arc& y){
+      return x.source == y.source && x.symbol == y.symbol && x.target == y.target;
+    }),a.end());
+    begin.assign(state_count+1,0);
+    for(auto it = a.begin();it!=a.end();++it) ++begin[it->source+1];
+    for(unsigned s = 0;s!=state_count;++s) begin[s+1] += begin[s];
+  }
+
+  unsigned start_state; ///< Der Startzustand
+  unsigned state_count; ///< Die Anzahl der Zustände
+  std::vector<Transitions::Arc> arcs; ///< Die Übergänge, nach Quelle, Symbol und Ziel sortiert
+  std::vector<unsigned> first; ///< Der Anfang der Übergänge je Zustand
+  std::vector<unsigned> epsilon_targets; ///< Die Ziele der Epsilon-Übergänge, nach Quelle sortiert
+  std::vector<unsigned> epsilon_first; ///< Der Anfang der Epsilon-Übergänge je Zustand
+  std::vector<bool> final; ///< Markiert die Endzustände
+  std::size_t malformed; ///< Anzahl fehlerhafter Zeilen
+
+};
+
+#endif
@@ -0,0 +1,362 @@
+////////////////////////////////////////////////////////////////////////////////
+// parallel.hpp
+// Klasse für das Hopcroft Projekt
+// Portable parallele Ausführung (ersetzt die Microsoft PPL)
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PARALLEL_HPP__
+#define __PARALLEL_HPP__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+//Optionale Backends: mit -DHOPCROFT_USE_TBB bzw. -DHOPCROFT_USE_STD_EXECUTION einschalten
+#ifdef HOPCROFT_USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#endif
+#ifdef HOPCROFT_USE_STD_EXECUTION
+#include <execution>
+#endif
+
+/** @brief Ein Threadpool mit Work-Stealing
+
+    Jeder Arbeiter hat seine eigene Warteschlange. Aufgaben, die ein Arbeiter erzeugt,
+    landen in seiner Schlange und werden von hinten abgearbeitet; ist sie leer,
+    stiehlt er von vorne aus den Schlangen der anderen. Wer auf Aufgaben wartet
+    (auch der aufrufende Thread), arbeitet währenddessen mit, so dass auch
+    verschachtelte Parallelität nicht blockiert.
+*/
+class ThreadPool{
+
+public:
+
+/** @brief Der Konstruktor der Klasse
+    @param n die Anzahl der Arbeiter-Threads
+*/
+ThreadPool(unsigned n){
+  stop = false;
+  pending = 0;
+  next = 0;
+  for(unsigned i = 0;i!=n;++i) queues.push_back(std::unique_ptr<Queue>(new Queue));
+  for(unsigned i = 0;i!=n;++i) workers.push_back(std::thread(&ThreadPool::work,this,i));
+}
+
+///@brief Der Destruktor beendet alle Arbeiter
+~ThreadPool(){
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    stop = true;
+  }
+  wake.notify_all();
+  for(auto it = workers.begin();it!=workers.end();++it) it->join();
+}
+
+///@brief Die Anzahl der Arbeiter
+unsigned size() const{
+  return workers.size();
+}
+
+/** @brief Reiht eine Aufgabe ein
+    @param task die Aufgabe
+*/
+void submit(std::function<void()> task){
+  unsigned i = current() >= 0 ? current() : next++ % queues.size();
+  {
+    std::lock_guard<std::mutex> lock(queues[i]->mutex);
+    queues[i]->tasks.push_back(std::move(task));
+  }
+  ++pending;
+  wake.notify_one();
+}
+
+/** @brief Führt eine wartende Aufgabe aus, zuerst aus der eigenen Schlange, sonst gestohlen
+    @return false wenn es keine Aufgabe gab
+*/
+bool run_one(){
+  std::function<void()> task;
+  int self = current();
+  if(self >= 0 && pop_back(self,task)){
+    task();
+    return true;
+  }
+  for(unsigned k = 0;k!=queues.size();++k){
+    unsigned i = (self >= 0 ? self + 1 + k : k) % queues.size();
+    if(pop_front(i,task)){
+      task();
+      return true;
+    }
+  }
+  return false;
+}
+
+private:
+
+///	@brief Die Warteschlange eines Arbeiters
+struct Queue{
+  std::mutex mutex;
+  std::deque<std::function<void()>> tasks;
+};
+
+//Die Nummer des Arbeiters im aktuellen Thread oder -1
+int current() const{
+  return worker_pool() == this ? worker_index() : -1;
+}
+
+static const ThreadPool*& worker_pool(){
+  static thread_local const ThreadPool* pool = nullptr;
+  return pool;
+}
+
+static int& worker_index(){
+  static thread_local int index = -1;
+  return index;
+}
+
+bool pop_back(unsigned i, std::function<void()>& task){
+  std::lock_guard<std::mutex> lock(queues[i]->mutex);
+  if(queues[i]->tasks.empty()) return false;
+  task = std::move(queues[i]->tasks.back());
+  queues[i]->tasks.pop_back();
+  --pending;
+  return true;
+}
+
+bool pop_front(unsigned i, std::function<void()>& task){
+  std::lock_guard<std::mutex> lock(queues[i]->mutex);
+  if(queues[i]->tasks.empty()) return false;
+  task = std::move(queues[i]->tasks.front());
+  queues[i]->tasks.pop_front();
+  --pending;
+  return true;
+}
+
+//Die Schleife eines Arbeiters
+void work(unsigned i){
+  worker_pool() = this;
+  worker_index() = i;
+  while(true){
+    if(run_one()) continue;
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    if(stop) return;
+    wake.wait_for(lock,std::chrono::milliseconds(10),[this]{ return stop || pending > 0; });
+    if(stop) return;
+  }
+}
+
+std::vector<std::unique_ptr<Queue>> queues; ///< Eine Warteschlange je Arbeiter
+std::vector<std::thread> workers; ///< Die Arbeiter
+std::atomic<unsigned> pending; ///< Die Anzahl wartender Aufgaben
+std::atomic<unsigned> next; ///< Verteilung von Aufgaben, die nicht aus einem Arbeiter kommen
+bool stop; ///< Signal zum Beenden
+std::mutex sleep_mutex; ///< Schützt stop und das Schlafen
+std::condition_variable wake; ///< Weckt schlafende Arbeiter
+
+};
+
+/** @brief Parallele Ausführungsschicht für die Minimierung
+
+    Stellt parallel_for und parallel_sort mit austauschbarem Backend bereit.
+    Die Einstellungen (Backend, Anzahl der Threads) gelten prozessweit.
+*/
+class Parallel{
+
+public:
+
+/** @brief Die verfügbaren Backends
+
+    SERIAL führt alles im aufrufenden Thread aus, POOL verwendet den eigenen
+    Work-Stealing-Threadpool. STD (std::execution::par) und TBB stehen nur zur
+    Verfügung, wenn mit HOPCROFT_USE_STD_EXECUTION bzw. HOPCROFT_USE_TBB übersetzt wurde.
+*/
+enum Backend{ SERIAL, POOL, STD, TBB };
+
+/** @brief Wählt das Backend
+    @param b das Backend; nicht einkompilierte Backends fallen auf POOL zurück
+*/
+static void set_backend(Backend b){
+#ifndef HOPCROFT_USE_STD_EXECUTION
+  if(b == STD) b = POOL;
+#endif
+#ifndef HOPCROFT_USE_TBB
+  if(b == TBB) b = POOL;
+#endif
+  settings().backend = b;
+}
+
+///@brief Das aktuelle Backend
+static Backend backend(){
+  return settings().backend;
+}
+
+/** @brief Legt die Anzahl der Threads fest (einschließlich des aufrufenden)
+    @param n die Anzahl der Threads, 0 = Anzahl der Prozessorkerne
+*/
+static void set_threads(unsigned n){
+  if(n == 0) n = std::max(1u,std::thread::hardware_concurrency());
+  std::lock_guard<std::mutex> lock(settings().mutex);
+  settings().threads = n;
+  settings().pool.reset();
+}
+
+///@brief Die Anzahl der Threads
+static unsigned threads(){
+  return settings().threads;
+}
+
+/** @brief Solange ein Objekt dieser Klasse lebt, laufen parallel_for und parallel_sort
+           im aktuellen Thread seriell, z.B. in Aufgaben, die selbst schon parallel verteilt werden
+*/
+class SerialScope{
+public:
+  SerialScope(){
+    previous = serial_thread();
+    serial_thread() = true;
+  }
+  ~SerialScope(){
+    serial_thread() = previous;
+  }
+private:
+  bool previous; ///< Der Zustand vor diesem Objekt, für verschachtelte Bereiche
+};
+
+/** @brief Führt f(i) für alle i aus [begin,end) parallel aus
+    @param begin der erste Index
+    @param end der Index hinter dem letzten
+    @param f das Funktionsobjekt
+    @param grain optional: die Mindestanzahl an Indizes je Aufgabe
+*/
+template<class F>
+static void parallel_for(int begin, int end, F f, int grain = 1024){
+  if(end - begin <= grain || threads() < 2 || backend() == SERIAL || serial_thread()){
+    for(int i = begin;i<end;++i) f(i);
+    return;
+  }
+#ifdef HOPCROFT_USE_TBB
+  if(backend() == TBB){
+    tbb::parallel_for(begin,end,f);
+    return;
+  }
+#endif
+  //Der Bereich wird in mehrere Stücke je Thread zerlegt, damit gestohlen werden kann
+  int chunks = std::min((end - begin + grain - 1) / grain,(int)threads() * 4);
+  int step = (end - begin + chunks - 1) / chunks;
+#ifdef HOPCROFT_USE_STD_EXECUTION
+  if(backend() == STD){
+    std::vector<int> starts;
+    for(int s = begin;s<end;s+=step) starts.push_back(s);
+    std::for_each(std::execution::par,starts.begin(),starts.end(),[&](int s){
+      for(int i = s;i<std::min(s + step,end);++i) f(i);
+    });
+    return;
+  }
+#endif
+  run_chunks(chunks,[&](int c){
+    int stop = std::min(begin + (c + 1) * step,end);
+    for(int i = begin + c * step;i<stop;++i) f(i);
+  });
+}
+
+/** @brief Sortiert einen Bereich parallel
+    @param first Anfang des Bereichs
+    @param last Ende des Bereichs
+    @param comp das Vergleichsobjekt
+*/
+template<class It, class Compare>
+static void parallel_sort(It first, It last, Compare comp){
+  int n = last - first;
+  if(n < 4096 || threads() < 2 || backend() == SERIAL || serial_thread()){
+    std::sort(first,last,comp);
+    return;
+  }
+#ifdef HOPCROFT_USE_TBB
+  if(backend() == TBB){
+    tbb::parallel_sort(first,last,comp);
+    return;
+  }
+#endif
+#ifdef HOPCROFT_USE_STD_EXECUTION
+  if(backend() == STD){
+    std::sort(std::execution::par,first,last,comp);
+    return;
+  }
+#endif
+  //Jedes Stück wird für sich sortiert, danach wird paarweise zusammengeführt
+  int chunks = 1;
+  while(chunks < (int)threads()) chunks *= 2;
+  int step = (n + chunks - 1) / chunks;
+  run_chunks(chunks,[&](int c){
+    std::sort(first + std::min(c * step,n),first + std::min((c + 1) * step,n),comp);
+  });
+  for(int width = step;width<n;width*=2){
+    int merges = (n + 2 * width - 1) / (2 * width);
+    run_chunks(merges,[&](int m){
+      int lo = m * 2 * width;
+      int mid = std::min(lo + width,n);
+      int hi = std::min(lo + 2 * width,n);
+      std::inplace_merge(first + lo,first + mid,first + hi,comp);
+    });
+  }
+}
+
+private:
+
+///	@brief Die prozessweiten Einstellungen
+struct Settings{
+  Settings(){
+    backend = POOL;
+    threads = std::max(1u,std::thread::hardware_concurrency());
+  }
+  Backend backend; ///< Das Backend
+  unsigned threads; ///< Die Anzahl der Threads
+  std::unique_ptr<ThreadPool> pool; ///< Der Pool, wird beim ersten Gebrauch erzeugt
+  std::mutex mutex; ///< Schützt die Erzeugung des Pools
+};
+
+static Settings& settings(){
+  static Settings s;
+  return s;
+}
+
+//true wenn im aktuellen Thread eine SerialScope aktiv ist
+static bool& serial_thread(){
+  static thread_local bool serial = false;
+  return serial;
+}
+
+//Der Pool hat einen Arbeiter weniger als Threads, da der Aufrufer mitarbeitet
+static ThreadPool& pool(){
+  std::lock_guard<std::mutex> lock(settings().mutex);
+  if(!settings().pool) settings().pool.reset(new ThreadPool(settings().threads - 1));
+  return *settings().pool;
+}
+
+//Führt f(0..chunks-1) als Aufgaben im Pool aus und arbeitet bis zum Ende mit
+template<class F>
+static void run_chunks(int chunks, F f){
+  ThreadPool& p = pool();
+  std::atomic<int> remaining(chunks);
+  for(int c = 1;c<chunks;++c){
+    p.submit([&f,&remaining,c]{
+      f(c);
+      --remaining;
+    });
+  }
+  f(0);
+  --remaining;
+  while(remaining > 0){
+    if(!p.run_one()) std::this_thread::yield();
+  }
+}
+
+};
+
+#endif
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+// partition.hpp
+// Klasse für das Hopcroft Projekt
+// Verfeinerbare Partition für die Worklist-Variante von Hopcroft
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PARTITION_HPP__
+#define __PARTITION_HPP__
+
+#include <vector>
+
+/** @brief Eine verfeinerbare Partition der Elemente 0..n-1 nach Valmari und Lehtinen
+
+    Die Elemente liegen mengenweise sortiert in einem Array. Markierte Elemente
+    werden an den Anfang ihrer Menge getauscht, split() trennt anschließend jede
+    teilweise markierte Menge und gibt dem kleineren Teil eine neue Nummer.
+    Da neue Mengen immer hinten angehängt werden, ergibt ein Zähler über die
+    Mengennummern direkt die Worklist mit "kleinerer Hälfte".
+*/
+class RefinablePartition{
+
+public:
+
+/** @brief Initialisiert die Partition mit einer einzigen Menge
+    @param n die Anzahl der Elemente
+*/
+void init(unsigned n){
+  sets = n ? 1 : 0;
+  elements.resize(n);
+  location.resize(n);
+  set_of.assign(n,0);
+  first.assign(n ? n : 1,0);
+  past.assign(n ? n : 1,0);
+  marked.assign(n ? n : 1,0);
+  touched.resize(n ? n : 1);
+  touched_count = 0;
+  for(unsigned i = 0;i!=n;++i){
+    elements[i] = i;
+    location[i] = i;
+  }
+  past[0] = n;
+}
+
+///@brief Die Anzahl der Mengen
+unsigned size() const{
+  return sets;
+}
+
+///@brief Die Menge, in der ein Element liegt
+unsigned set(unsigned e) const{
+  return set_of[e];
+}
+
+///@brief Position des ersten Elements einer Menge
+unsigned begin(unsigned s) const{
+  return first[s];
+}
+
+///@brief Position hinter dem letzten Element einer Menge
+unsigned end(unsigned s) const{
+  return past[s];
+}
+
+///@brief Das Element an Position i
+unsigned element(unsigned i) const{
+  return elements[i];
+}
+
+///@brief Markiert ein Element für den nächsten split()
+void mark(unsigned e){
+  unsigned s = set_of[e];
+  unsigned i = location[e];
+  unsigned j = first[s] + marked[s];
+  elements[i] = elements[j];
+  location[elements[i]] = i;
+  elements[j] = e;
+  location[e] = j;
+  if(!marked[s]++) touched[touched_count++] = s;
+}
+
+///@brief Teilt alle teilweise markierten Mengen, der kleinere Teil erhält eine neue Nummer
+void split(){
+  while(touched_count){
+    unsigned s = touched[--touched_count];
+    unsigned j = first[s] + marked[s];
+    if(j == past[s]){
+      marked[s] = 0;
+      continue;
+    }
+    if(marked[s] <= past[s] - j){
+      first[sets] = first[s];
+      past[sets] = first[s] = j;
+    }
+    else{
+      past[sets] = past[s];
+      first[sets] = past[s] = j;
+    }
+    for(unsigned i = first[sets];i!=past[sets];++i) set_of[elements[i]] = sets;
+    marked[s] = marked[sets] = 0;
+    ++sets;
+  }
+}
+
+private:
+
+unsigned sets; ///< Die Anzahl der Mengen
+std::vector<unsigned> elements; ///< Die Elemente, mengenweise zusammenhängend
+std::vector<unsigned> location; ///< Die Position jedes Elements in elements
+std::vector<unsigned> set_of; ///< Die Menge jedes Elements
+std::vector<unsigned> first; ///< Der Anfang jeder Menge in elements
+std::vector<unsigned> past; ///< Das Ende jeder Menge in elements
+std::vector<unsigned> marked; ///< Die Anzahl markierter Elemente je Menge
+std::vector<unsigned> touched; ///< Mengen mit markierten Elementen
+unsigned touched_count; ///< Anzahl der Einträge in touched
+
+};
+
+#endif
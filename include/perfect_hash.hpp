@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////
+// perfect_hash.hpp
+// Klasse für das Hopcroft Projekt
+// Minimales perfektes Hashing (Wort <-> Index) über einem azyklischen Automaten
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PERFECT_HASH_HPP__
+#define __PERFECT_HASH_HPP__
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "DFA.hpp"
+
+/** @brief Minimales perfektes Hashing über einem azyklischen Automaten
+
+    Jeder Zustand wird mit der Anzahl der von ihm aus akzeptierten Suffixe annotiert.
+    Daraus erhält jeder Übergang einen Sprungwert: die Anzahl der Wörter, die an
+    dieser Stelle kleiner sind (das leere Suffix, falls der Zustand ein Endzustand ist,
+    und alle Suffixe über kleinere Symbole). Die Summe der Sprungwerte entlang eines
+    Wortes ist sein Rang in Bytereihenfolge, also ein Index aus [0, size()).
+    Beide Richtungen kosten O(|Wort|) Schritte; Nutzdaten können damit in einem
+    flachen Array neben dem Automaten liegen.
+*/
+class PerfectHash{
+
+  public:
+
+  static constexpr std::uint64_t NONE = ~std::uint64_t(0); ///< Rückgabewert von index() für unbekannte Wörter
+
+  /** @brief Der Konstruktor der Klasse
+      @param dfa Der Automat; er muss azyklisch sein, sonst ist valid() false
+  */
+  PerfectHash(const DFA& dfa){
+    unsigned n = dfa.state_count;
+    start_state = dfa.start_state;
+    //Eigene CSR-Kopie der Übergänge
+    offsets.assign(n+1,0);
+    for(unsigned i = 0;i!=n;++i) offsets[i+1] = offsets[i] + dfa.transitions.degree(i);
+    symbols.resize(offsets[n]);
+    targets.resize(offsets[n]);
+    skip.resize(offsets[n]);
+    for(unsigned i = 0;i!=n;++i){
+      unsigned k = offsets[i];
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j,++k){
+        symbols[k] = dfa.transitions.symbol(j);
+        targets[k] = dfa.transitions.target(j);
+      }
+    }
+    final.assign(n,0);
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) final[*it] = 1;
+
+    //Anzahl der Suffixe je Zustand, in umgekehrter topologischer Reihenfolge (iterative Tiefensuche)
+    counts.assign(n,0);
+    std::vector<unsigned char> color(n,0); //0 = neu, 1 = auf dem Stapel, 2 = fertig
+    std::vector<std::pair<unsigned,unsigned> > stack;
+    ok = true;
+    for(unsigned root = 0;root!=n && ok;++root){
+      if(color[root]) continue;
+      stack.push_back(std::make_pair(root,offsets[root]));
+      color[root] = 1;
+      while(!stack.empty() && ok){
+        unsigned s = stack.back().first;
+        unsigned& k = stack.back().second;
+        if(k != offsets[s+1]){
+          unsigned t = targets[k++];
+          if(color[t] == 1) ok = false;
+          else if(color[t] == 0){
+            color[t] = 1;
+            stack.push_back(std::make_pair(t,offsets[t]));
+          }
+          continue;
+        }
+        //Alle Nachfolger sind fertig: Sprungwerte und Anzahl berechnen
+        std::uint64_t c = final[s];
+        for(unsigned j = offsets[s];j!=offsets[s+1];++j){
+          skip[j] = c;
+          c += counts[targets[j]];
+        }
+        counts[s] = c;
+        color[s] = 2;
+        stack.pop_back();
+      }
+    }
+    if(!ok) std::cerr << "Error: perfect hashing needs an acyclic automaton.\n";
+  }
+
+  ///@brief false wenn der Automat einen Zyklus hat
+  bool valid() const{
+    return ok;
+  }
+
+  ///@brief Die Anzahl der Wörter
+  std::uint64_t size() const{
+    return ok && !counts.empty() ? counts[start_state] : 0;
+  }
+
+  /** @brief Der Index eines Wortes (sein Rang in Bytereihenfolge)
+      @param word Das Wort
+      @return der Index oder NONE wenn das Wort nicht akzeptiert wird
+  */
+  std::uint64_t index(const std::string& word) const{
+    if(!ok) return NONE;
+    unsigned state = start_state;
+    std::uint64_t result = 0;
+    for(std::size_t i = 0;i!=word.size();++i){
+      unsigned j = offsets[state];
+      while(j != offsets[state+1] && symbols[j] != word[i]) ++j;
+      if(j == offsets[state+1]) return NONE;
+      result += skip[j];
+      state = targets[j];
+    }
+    return final[state] ? result : NONE;
+  }
+
+  /** @brief Das Wort zu einem Index
+      @param index Der Index aus [0, size())
+      @param word Das Wort
+      @return false wenn der Index zu groß ist
+  */
+  bool word(std::uint64_t index, std::string& word) const{
+    word.clear();
+    if(index >= size()) return false;
+    unsigned state = start_state;
+    while(true){
+      if(final[state]){
+        if(index == 0) return true;
+      }
+      //Der letzte Übergang, dessen Sprungwert nicht größer als der Rest ist
+      unsigned j = offsets[state];
+      while(j + 1 != offsets[state+1] && skip[j+1] <= index) ++j;
+      index -= skip[j];
+      word += symbols[j];
+      state = targets[j];
+    }
+  }
+
+  ///@brief Der belegte Speicher in Bytes
+  std::size_t memory() const{
+    return offsets.capacity() * sizeof(unsigned) + symbols.capacity() + targets.capacity() * sizeof(unsigned)
+         + skip.capacity() * sizeof(std::uint64_t) + counts.capacity() * sizeof(std::uint64_t) + final.capacity();
+  }
+
+  private:
+
+  unsigned start_state; ///< Der Startzustand
+  bool ok; ///< false wenn der Automat zyklisch ist
+  std::vector<unsigned> offsets; ///< Die Zeilenanfänge
+  std::vector<char> symbols; ///< Die Symbole, zeilenweise sortiert
+  std::vector<unsigned> targets; ///< Die Zielzustände
+  std::vector<std::uint64_t> skip; ///< Die Sprungwerte der Übergänge
+  std::vector<std::uint64_t> counts; ///< Die Anzahl akzeptierter Suffixe je Zustand
+  std::vector<unsigned char> final; ///< 1 für Endzustände
+
+};
+
+#endif
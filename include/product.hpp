@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+// product.hpp
+// Klasse für das Hopcroft Projekt
+// Produktautomaten (Schnitt, Vereinigung, Differenz) mit Aufbau bei Bedarf
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PRODUCT_HPP__
+#define __PRODUCT_HPP__
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include "DFA.hpp"
+
+/** @brief Der Produktautomat zweier DFAs, dessen Zustände erst bei Bedarf entstehen
+
+    Ein Zustand des Produkts ist ein Paar aus je einem Zustand der beiden
+    Automaten; fehlt einem Automaten ein Übergang, steht an seiner Stelle die
+    Senke. Jedes Paar bekommt beim ersten Erreichen eine Nummer (Memo-Tabelle),
+    seine Zeile wird erst beim ersten Durchlaufen aus den beiden sortierten Zeilen
+    der Operanden zusammengeführt und danach wiederverwendet. Abfragen mit
+    accepts() erzeugen also nur die Paare entlang der abgefragten Wörter,
+    materialize() nur die vom Start erreichbaren Paare, nie alle |Q1|·|Q2|.
+    Paare, von denen aus nichts mehr erkannt werden kann, weil die Senke
+    entscheidet, werden gar nicht erst angelegt.
+
+    Die Operanden dürfen sich während der Lebensdauer des Produkts nicht ändern.
+    Da auch Abfragen den Automaten erweitern, ist ein Produkt nicht für
+    gleichzeitige Abfragen aus mehreren Threads geeignet.
+*/
+class Product{
+
+  public:
+
+  /// @brief Die Verknüpfung der beiden Sprachen
+  enum Operation{
+    INTERSECTION, ///< Wörter beider Automaten
+    UNION, ///< Wörter mindestens eines Automaten
+    DIFFERENCE ///< Wörter des ersten, die der zweite nicht erkennt
+  };
+
+  /** @brief Der Konstruktor der Klasse, legt nur den Startzustand an
+      @param a Der erste Automat
+      @param b Der zweite Automat
+      @param op Die Verknüpfung
+  */
+  Product(const DFA& a, const DFA& b, Operation op) : first(a), second(b){
+    operation = op;
+    expanded = 0;
+    pair(a.start_state,b.start_state);
+  }
+
+  /** @brief Prüft, ob ein Wort erkannt wird, und legt dabei fehlende Zustände an
+      @param word Das Wort
+      @param length Die Länge des Wortes
+      @return true wenn das Wort in der verknüpften Sprache liegt
+  */
+  bool accepts(const char* word, std::size_t length){
+    unsigned s = 0;
+    for(std::size_t i = 0;i!=length;++i){
+      if(row[s] == NONE) expand(s);
+      unsigned t = NONE;
+      unsigned char c = (unsigned char)word[i];
+      //Die Zeilen sind kurz und sortiert, daher genügt eine lineare Suche
+      for(unsigned j = row[s];j!=row[s]+degree[s];++j){
+        if((unsigned char)symbols[j] < c) continue;
+        if((unsigned char)symbols[j] == c) t = targets[j];
+        break;
+      }
+      if(t == NONE) return false;
+      s = t;
+    }
+    return finals[s];
+  }
+
+  /** @brief Prüft, ob ein Wort erkannt wird, und legt dabei fehlende Zustände an
+      @param word Das Wort
+      @return true wenn das Wort in der verknüpften Sprache liegt
+  */
+  bool accepts(const std::string& word){
+    return accepts(word.data(),word.size());
+  }
+
+  /** @brief Legt alle vom Start erreichbaren Zustände an und schreibt sie in einen DFA
+      @param dfa Der Zielautomat, frisch mit DFA() erzeugt; darf keiner der Operanden sein
+  */
+  void materialize(DFA& dfa){
+    //Neue Paare werden hinten angehängt, die Schleife ist also eine Breitensuche
+    for(unsigned s = 0;s!=left.size();++s){
+      if(row[s] == NONE) expand(s);
+    }
+    unsigned n = left.size();
+    std::vector<Transitions::Arc> arcs;
+    arcs.reserve(symbols.size());
+    for(unsigned s = 0;s!=n;++s){
+      for(unsigned j = row[s];j!=row[s]+degree[s];++j){
+        Transitions::Arc arc;
+        arc.source = s;
+        arc.target = targets[j];
+        arc.symbol = symbols[j];
+        arcs.push_back(arc);
+        dfa.alphabet.add(arc.symbol);
+      }
+    }
+    dfa.transitions.assign(n,arcs);
+    dfa.state_count = n;
+    dfa.transition_count = arcs.size();
+    dfa.start_state = 0;
+    dfa.signatures.assign(n);
+    for(auto it = arcs.begin();it!=arcs.end();++it) dfa.signatures.add(it->source,dfa.alphabet[it->symbol]);
+    dfa.final_states.clear();
+    for(unsigned s = 0;s!=n;++s){
+      if(!finals[s]) continue;
+      dfa.final_states.insert(s);
+      dfa.signatures.set_final(s);
+    }
+  }
+
+  ///@brief Die Anzahl der bisher angelegten Paare
+  std::size_t states() const{
+    return left.size();
+  }
+
+  ///@brief Die Anzahl der Paare, deren Zeile schon zusammengeführt wurde
+  std::size_t expanded_states() const{
+    return expanded;
+  }
+
+  ///@brief Die Anzahl aller möglichen Paare, |Q1|·|Q2|
+  std::uint64_t bound() const{
+    return std::uint64_t(first.state_count) * second.state_count;
+  }
+
+  private:
+
+  static constexpr unsigned NONE = ~0u; ///< Die Senke bzw. eine noch nicht zusammengeführte Zeile
+
+  //true wenn von einem Paar aus überhaupt noch ein Wort erkannt werden kann
+  bool alive(unsigned p, unsigned q) const{
+    if(operation == INTERSECTION) return p != NONE && q != NONE;
+    if(operation == UNION) return p != NONE || q != NONE;
+    return p != NONE;
+  }
+
+  //Die Nummer eines Paares, legt es bei Bedarf an
+  unsigned pair(unsigned p, unsigned q){
+    std::uint64_t key = (std::uint64_t(p) << 32) | q;
+    auto it = memo.find(key);
+    if(it != memo.end()) return it->second;
+    unsigned s = left.size();
+    memo.insert(std::make_pair(key,s));
+    left.push_back(p);
+    right.push_back(q);
+    row.push_back(NONE);
+    degree.push_back(0);
+    bool fp = p != NONE && first.final_states.count(p);
+    bool fq = q != NONE && second.final_states.count(q);
+    if(operation == INTERSECTION) finals.push_back(fp && fq);
+    else if(operation == UNION) finals.push_back(fp || fq);
+    else finals.push_back(fp && !fq);
+    return s;
+  }
+
+  //Führt die Zeilen beider Automaten zur Zeile eines Paares zusammen
+  void expand(unsigned s){
+    unsigned p = left[s], q = right[s];
+    unsigned i = p == NONE ? 0 : first.transitions.begin(p), ie = p == NONE ? 0 : first.transitions.end(p);
+    unsigned j = q == NONE ? 0 : second.transitions.begin(q), je = q == NONE ? 0 : second.transitions.end(q);
+    //Neue Paare ändern nur die Vektoren je Paar, die Zeile bleibt zusammenhängend
+    unsigned begin = symbols.size();
+    while(i != ie || j != je){
+      unsigned ci = i != ie ? (unsigned char)first.transitions.symbol(i) : 256;
+      unsigned cj = j != je ? (unsigned char)second.transitions.symbol(j) : 256;
+      unsigned c = std::min(ci,cj);
+      unsigned a = ci == c ? first.transitions.target(i++) : NONE;
+      unsigned b = cj == c ? second.transitions.target(j++) : NONE;
+      if(!alive(a,b)) continue;
+      unsigned t = pair(a,b);
+      symbols.push_back((char)c);
+      targets.push_back(t);
+    }
+    row[s] = begin;
+    degree[s] = symbols.size() - begin;
+    ++expanded;
+  }
+
+  const DFA& first; ///< Der erste Automat
+  const DFA& second; ///< Der zweite Automat
+  Operation operation; ///< Die Verknüpfung
+  std::unordered_map<std::uint64_t,unsigned> memo; ///< Die Nummern der angelegten Paare
+  std::vector<unsigned> left; ///< Der Zustand des ersten Automaten je Paar oder NONE
+  std::vector<unsigned> right; ///< Der Zustand des zweiten Automaten je Paar oder NONE
+  std::vector<bool> finals; ///< Markiert die Endzustände des Produkts
+  std::vector<unsigned> row; ///< Der Anfang der Zeile je Paar oder NONE
+  std::vector<unsigned> degree; ///< Die Länge der Zeile je Paar
+  std::vector<char> symbols; ///< Die Symbole aller zusammengeführten Zeilen
+  std::vector<unsigned> targets; ///< Die Zielpaare aller zusammengeführten Zeilen
+  std::size_t expanded; ///< Die Anzahl der zusammengeführten Zeilen
+
+};
+
+#endif
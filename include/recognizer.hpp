@@ -0,0 +1,196 @@
+////////////////////////////////////////////////////////////////////////////////
+// recognizer.hpp
+// Klasse für das Hopcroft Projekt
+// Schnelle Abfragen (Mitgliedschaft, Präfixe) auf einem fertigen Automaten
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __RECOGNIZER_HPP__
+#define __RECOGNIZER_HPP__
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <memory>
+#include "DFA.hpp"
+
+/** @brief Ein schreibgeschützter Erkenner für einen (minimierten) Automaten
+
+    Der Automat wird in eine dichte Tabelle (DenseTransitions) mit einer Spalte je Alphabetsymbol
+    umgeschrieben; ein Byte wird über eine Tabelle mit 256 Einträgen auf seine
+    Spalte abgebildet. Jeder Schritt ist damit ein einziger Tabellenzugriff.
+    Für Stapel von Wörtern werden mehrere Wörter verschränkt abgearbeitet, so
+    dass sich die Speicherlatenzen der unabhängigen Zugriffe überlappen.
+
+    Der Erkenner ist eine Momentaufnahme: spätere Änderungen am DFA wirken sich
+    nicht aus.
+*/
+class Recognizer{
+
+  public:
+
+  static constexpr unsigned LANES = 8; ///< Anzahl der verschränkt abgearbeiteten Wörter
+
+  /** @brief Der Konstruktor der Klasse
+      @param dfa Der Automat
+  */
+  Recognizer(const DFA& dfa){
+    //Spaltenzuordnung der Bytes
+    for(unsigned c = 0;c!=256;++c) column[c] = Transitions::NONE;
+    width = 0;
+    for(unsigned i = 0;i!=dfa.state_count;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        unsigned char c = dfa.transitions.symbol(j);
+        if(column[c] == Transitions::NONE) column[c] = width++;
+      }
+    }
+    //Bytes, die nicht im Automaten vorkommen, teilen sich eine eigene, leere Spalte
+    for(unsigned c = 0;c!=256;++c){
+      if(column[c] == Transitions::NONE) column[c] = width;
+    }
+    ++width;
+    //Die Tabelle; Zustand n ist eine Senke, damit fehlende Übergänge keinen Sonderfall brauchen
+    sink = dfa.state_count;
+    table.build(dfa.transitions,width,[this](char c){ return column[(unsigned char)c]; },sink);
+
+    start_state = dfa.start_state;
+    final.assign(sink + 1,0);
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it) final[*it] = 1;
+
+    //Zustände, von denen aus ein Endzustand erreichbar ist (Rückwärtssuche)
+    live.assign(sink + 1,0);
+    std::vector<unsigned> first(sink + 2,0);
+    for(unsigned i = 0;i!=sink;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j) ++first[dfa.transitions.target(j)+1];
+    }
+    for(unsigned i = 0;i<=sink;++i) first[i+1] += first[i];
+    std::vector<unsigned> preds(first[sink+1]);
+    std::vector<unsigned> next(first.begin(),first.end()-1);
+    for(unsigned i = 0;i!=sink;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j) preds[next[dfa.transitions.target(j)]++] = i;
+    }
+    std::vector<unsigned> stack;
+    for(unsigned i = 0;i!=sink;++i){
+      if(final[i]){
+        live[i] = 1;
+        stack.push_back(i);
+      }
+    }
+    while(!stack.empty()){
+      unsigned s = stack.back();
+      stack.pop_back();
+      for(unsigned j = first[s];j!=first[s+1];++j){
+        if(!live[preds[j]]){
+          live[preds[j]] = 1;
+          stack.push_back(preds[j]);
+        }
+      }
+    }
+  }
+
+  /** @brief Prüft ob der Automat ein Wort akzeptiert
+      @param word Das Wort
+  */
+  bool accepts(const std::string& word) const{
+    return final[run(word.data(),word.size())];
+  }
+
+  /** @brief Prüft ob der Automat ein Wort akzeptiert
+      @param word Der Anfang des Wortes
+      @param length Die Länge des Wortes
+  */
+  bool accepts(const char* word, std::size_t length) const{
+    return final[run(word,length)];
+  }
+
+  /** @brief Prüft einen Stapel von Wörtern. Je LANES Wörter werden verschränkt
+             abgearbeitet, damit mehrere Tabellenzugriffe gleichzeitig unterwegs sind.
+      @param words Der Anfang des Stapels
+      @param count Die Anzahl der Wörter
+      @param results Für jedes Wort true wenn es akzeptiert wird
+  */
+  void accepts(const std::string* words, std::size_t count, bool* results) const{
+    std::size_t i = 0;
+    for(;i + LANES <= count;i += LANES){
+      unsigned state[LANES];
+      const char* word[LANES];
+      std::size_t shortest = words[i].size();
+      for(unsigned l = 0;l!=LANES;++l){
+        state[l] = start_state;
+        word[l] = words[i+l].data();
+        if(words[i+l].size() < shortest) shortest = words[i+l].size();
+      }
+      //Gemeinsame Länge: alle Spuren ohne Verzweigung im Gleichschritt
+      for(std::size_t k = 0;k!=shortest;++k){
+        for(unsigned l = 0;l!=LANES;++l) state[l] = step(state[l],word[l][k]);
+      }
+      //Der Rest jeder Spur einzeln
+      for(unsigned l = 0;l!=LANES;++l){
+        for(std::size_t k = shortest;k!=words[i+l].size();++k) state[l] = step(state[l],word[l][k]);
+        results[i+l] = final[state[l]];
+      }
+    }
+    for(;i!=count;++i) results[i] = accepts(words[i]);
+  }
+
+  /** @brief Prüft einen Stapel von Wörtern
+      @param words Die Wörter
+      @param results Für jedes Wort true wenn es akzeptiert wird
+  */
+  void accepts(const std::vector<std::string>& words, std::vector<bool>& results) const{
+    std::unique_ptr<bool[]> buffer(new bool[words.size()]);
+    accepts(words.data(),words.size(),buffer.get());
+    results.assign(buffer.get(),buffer.get() + words.size());
+  }
+
+  /** @brief Prüft ob ein Wort Präfix eines akzeptierten Wortes ist
+      @param word Das Wort
+  */
+  bool is_prefix(const std::string& word) const{
+    return live[run(word.data(),word.size())];
+  }
+
+  /** @brief Die Länge des längsten Präfixes eines Wortes, das akzeptiert wird
+      @param word Das Wort
+      @return die Länge oder std::string::npos wenn kein Präfix (auch nicht das leere Wort) akzeptiert wird
+  */
+  std::size_t longest_match(const std::string& word) const{
+    std::size_t longest = std::string::npos;
+    unsigned state = start_state;
+    if(final[state]) longest = 0;
+    for(std::size_t k = 0;k!=word.size() && live[state];++k){
+      state = step(state,word[k]);
+      if(final[state]) longest = k + 1;
+    }
+    return longest;
+  }
+
+  ///@brief Der belegte Speicher in Bytes
+  std::size_t memory() const{
+    return table.memory() + final.capacity() + live.capacity();
+  }
+
+  private:
+
+  //Ein Schritt; fehlende Übergänge führen in die Senke
+  unsigned step(unsigned state, char c) const{
+    return table(state,column[(unsigned char)c]);
+  }
+
+  //Lässt den Automaten über ein Wort laufen und gibt den erreichten Zustand zurück
+  unsigned run(const char* word, std::size_t length) const{
+    unsigned state = start_state;
+    for(std::size_t k = 0;k!=length;++k) state = step(state,word[k]);
+    return state;
+  }
+
+  unsigned column[256]; ///< Die Spalte jedes Bytes
+  unsigned width; ///< Die Anzahl der Spalten
+  unsigned sink; ///< Die Senke (= Anzahl der Zustände des DFA)
+  unsigned start_state; ///< Der Startzustand
+  DenseTransitions table; ///< Die Übergänge, zeilenweise je Zustand einschließlich der Senke
+  std::vector<unsigned char> final; ///< 1 für Endzustände
+  std::vector<unsigned char> live; ///< 1 für Zustände, von denen ein Endzustand erreichbar ist
+
+};
+
+#endif
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////
+// renumber.hpp
+// Klasse für das Hopcroft Projekt
+// Neunummerierung der Zustände für bessere Speicherlokalität
+////////////////////////////////////////////////////////////////////////////////
+
+//Vor dem Include-Guard, da DFA.hpp diese Datei vor hopcroft.hpp einbindet
+#include "DFA.hpp"
+
+#ifndef __RENUMBER_HPP__
+#define __RENUMBER_HPP__
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+
+/** @brief Nummeriert die Zustände eines Automaten in Durchlaufreihenfolge neu
+
+    Nach der Minimierung folgen die Nummern den Blöcken der Partition und haben
+    mit der Reihenfolge, in der Wörter den Automaten durchlaufen, nichts zu tun.
+    Da die Zeilen der Übergänge (und die Tabellen von Recognizer, BinaryFormat
+    und DFA::generate) nach Zustandsnummer angeordnet sind, springt jede Abfrage
+    durch den Speicher. Die neue Reihenfolge legt Zustände, die nacheinander
+    besucht werden, nebeneinander:
+    - BFS: Breitensuche vom Startzustand, Zustände gleicher Tiefe liegen beisammen
+    - DFS: Tiefensuche (Präordnung, kleinstes Symbol zuerst), ein Wort läuft
+      möglichst lange über aufeinanderfolgende Zustände
+    - FREQUENCY: nach der Anzahl der Besuche beim Durchlaufen einer Stichprobe von
+      Abfragen, häufige Zustände zuerst; Gleichstände und nie besuchte Zustände
+      in DFS-Reihenfolge
+    Der Startzustand wird immer zur 0. Vom Start aus unerreichbare Zustände
+    behalten ihre Reihenfolge und folgen am Ende.
+*/
+class Renumbering{
+
+  public:
+
+  /// @brief Die neue Reihenfolge der Zustände
+  enum Order{
+    KEEP, ///< Keine Neunummerierung
+    BFS, ///< Breitensuche vom Startzustand
+    DFS, ///< Tiefensuche vom Startzustand
+    FREQUENCY ///< Häufigkeit in einer Stichprobe von Abfragen, siehe set_sample()
+  };
+
+  /** @brief Der Konstruktor der Klasse
+      @param o optional: die neue Reihenfolge. Default = BFS
+  */
+  Renumbering(Order o = BFS){
+    order = o;
+    sample = nullptr;
+    seconds = 0;
+  }
+
+  /** @brief Wählt die neue Reihenfolge
+      @param o die Reihenfolge
+  */
+  void set_order(Order o){
+    order = o;
+  }
+
+  /** @brief Legt die Stichprobe von Abfragen für FREQUENCY fest, die Wörter werden nicht kopiert
+      @param words Die Wörter, sie müssen bis zum Aufruf erhalten bleiben
+  */
+  void set_sample(const std::vector<std::string>& words){
+    sample = &words;
+  }
+
+  /** @brief Nummeriert die Zustände neu
+      @param dfa Der Automat
+      @return true wenn sich die Nummerierung geändert hat
+  */
+  bool operator()(DFA& dfa){
+    auto start = std::chrono::steady_clock::now();
+    unsigned n = dfa.state_count;
+    if(order == KEEP){
+      number.clear();
+      seconds = 0;
+      return false;
+    }
+    number.assign(n,Transitions::NONE);
+    sequence.clear();
+    sequence.reserve(n);
+    if(order == BFS) breadth_first(dfa);
+    else if(order == DFS || order == FREQUENCY) depth_first(dfa);
+    if(order == FREQUENCY){
+      if(!sample) std::cerr << "Warning: no sample of queries for the frequency order, using DFS.\n";
+      else by_frequency(dfa);
+    }
+    //Unerreichbare Zustände in alter Reihenfolge ans Ende
+    for(unsigned s = 0;s!=n;++s){
+      if(number[s] == Transitions::NONE) append(s);
+    }
+    bool changed = false;
+    for(unsigned s = 0;s!=n && !changed;++s) changed = number[s] != s;
+    if(changed) apply(dfa);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return changed;
+  }
+
+  ///@brief Die neue Nummer je alter Nummer beim letzten Aufruf, leer bei KEEP
+  const std::vector<unsigned>& mapping() const{
+    return number;
+  }
+
+  ///@brief Die Dauer des letzten Aufrufs in Sekunden
+  double duration() const{
+    return seconds;
+  }
+
+  private:
+
+  //Vergibt die nächste Nummer
+  void append(unsigned s){
+    number[s] = sequence.size();
+    sequence.push_back(s);
+  }
+
+  //Nummern in Breitensuche, sequence dient zugleich als Warteschlange
+  void breadth_first(const DFA& dfa){
+    append(dfa.start_state);
+    for(std::size_t head = 0;head!=sequence.size();++head){
+      unsigned s = sequence[head];
+      for(unsigned j = dfa.transitions.begin(s);j!=dfa.transitions.end(s);++j){
+        if(number[dfa.transitions.target(j)] == Transitions::NONE) append(dfa.transitions.target(j));
+      }
+    }
+  }
+
+  //Nummern in Präordnung einer Tiefensuche, das kleinste Symbol zuerst
+  void depth_first(const DFA& dfa){
+    std::vector<unsigned> stack(1,dfa.start_state);
+    while(!stack.empty()){
+      unsigned s = stack.back();
+      stack.pop_back();
+      if(number[s] != Transitions::NONE) continue;
+      append(s);
+      for(unsigned j = dfa.transitions.end(s);j!=dfa.transitions.begin(s);--j){
+        if(number[dfa.transitions.target(j-1)] == Transitions::NONE) stack.push_back(dfa.transitions.target(j-1));
+      }
+    }
+  }
+
+  //Sortiert die erreichbaren Zustände stabil nach der Anzahl der Besuche in der Stichprobe
+  void by_frequency(const DFA& dfa){
+    std::vector<std::size_t> visits(dfa.state_count,0);
+    for(auto it = sample->begin();it!=sample->end();++it){
+      unsigned s = dfa.start_state;
+      ++visits[s];
+      for(std::size_t i = 0;i!=it->size() && s!=Transitions::NONE;++i){
+        s = dfa.transitions.find(s,(*it)[i]);
+        if(s != Transitions::NONE) ++visits[s];
+      }
+    }
+    //Der Startzustand bleibt vorn, auch wenn die Stichprobe leer ist
+    std::stable_sort(sequence.begin()+1,sequence.end(),[&visits](unsigned a, unsigned b){
+      return visits[a] > visits[b];
+    });
+    for(std::size_t i = 0;i!=sequence.size();++i) number[sequence[i]] = i;
+  }
+
+  //Schreibt den Automaten mit den neuen Nummern
+  void apply(DFA& dfa){
+    unsigned n = dfa.state_count;
+    std::vector<Transitions::Arc> arcs;
+    arcs.reserve(dfa.transitions.edges());
+    for(unsigned i = 0;i!=n;++i){
+      unsigned s = sequence[i];
+      for(unsigned j = dfa.transitions.begin(s);j!=dfa.transitions.end(s);++j){
+        Transitions::Arc arc;
+        arc.source = i;
+        arc.target = number[dfa.transitions.target(j)];
+        arc.symbol = dfa.transitions.symbol(j);
+        arcs.push_back(arc);
+      }
+    }
+    dfa.transitions.assign(n,arcs);
+    dfa.signatures.assign(n);
+    for(auto it = arcs.begin();it!=arcs.end();++it) dfa.signatures.add(it->source,dfa.alphabet[it->symbol]);
+    std::unordered_set<unsigned> finals;
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it){
+      finals.insert(number[*it]);
+      dfa.signatures.set_final(number[*it]);
+    }
+    dfa.final_states.swap(finals);
+    dfa.start_state = number[dfa.start_state];
+  }
+
+  Order order; ///< Die neue Reihenfolge
+  const std::vector<std::string>* sample; ///< Die Stichprobe von Abfragen für FREQUENCY
+  std::vector<unsigned> number; ///< Die neue Nummer je alter Nummer
+  std::vector<unsigned> sequence; ///< Die alten Nummern in neuer Reihenfolge
+  double seconds; ///< Die Dauer des letzten Aufrufs
+
+};
+
+#endif
@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////
+// sharded.hpp
+// Klasse für das Hopcroft Projekt
+// Paralleler Aufbau minimaler Lexikonautomaten aus Teilautomaten
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SHARDED_HPP__
+#define __SHARDED_HPP__
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include "DFA.hpp"
+#include "daciuk.hpp"
+#include "parallel.hpp"
+
+/** @brief Baut den minimalen Automaten eines Lexikons parallel in Teilen (Shards)
+
+    Die Wörter werden parallel sortiert und nach ihrem ersten Byte in zusammen-
+    hängende Bereiche etwa gleicher Größe zerlegt. Jeder Bereich wird auf einem
+    eigenen Kern mit Daciuk (sortierter Modus) zu einem minimalen Teilautomaten
+    aufgebaut. Da sich die Bereiche im ersten Byte unterscheiden, hängen die
+    Teilautomaten unterhalb eines gemeinsamen Startzustands einfach nebeneinander.
+    Gleiche Endungen verschiedener Bereiche werden zum Schluss von Hopcroft mit
+    REVUZ in einem linearen Durchlauf zusammengelegt.
+
+    Ein erstes Byte wird nie geteilt, die Anzahl nutzbarer Shards ist also durch
+    die Anzahl verschiedener Anfangsbytes beschränkt.
+*/
+class ShardedBuilder{
+
+  public:
+
+  /** @brief Der Konstruktor der Klasse
+      @param n optional: die gewünschte Anzahl an Shards, 0 = vier je Thread. Default = 0
+  */
+  ShardedBuilder(unsigned n = 0){
+    wanted = n;
+    used = 0;
+    build_seconds = 0;
+    merge_seconds = 0;
+    minimize_seconds = 0;
+  }
+
+  /** @brief Baut den minimalen Automaten der Wörter
+      @param dfa Der Zielautomat, frisch mit DFA() erzeugt
+      @param words Die Wörter in beliebiger Reihenfolge; sie werden sortiert und Duplikate entfernt
+  */
+  void operator()(DFA& dfa, std::vector<std::string>& words){
+    auto t0 = std::chrono::steady_clock::now();
+    Parallel::parallel_sort(words.begin(),words.end(),std::less<std::string>());
+    words.erase(std::unique(words.begin(),words.end()),words.end());
+
+    //Das leere Wort gehört zum gemeinsamen Startzustand
+    bool empty = !words.empty() && words.front().empty();
+    std::size_t first = empty ? 1 : 0;
+    std::vector<std::size_t> bounds = split(words,first);
+    used = bounds.size() - 1;
+
+    std::vector<std::unique_ptr<DFA> > shards(used);
+    Parallel::parallel_for(0,used,[&](int k){
+      shards[k].reset(new DFA);
+      Daciuk builder(*shards[k]);
+      for(std::size_t i = bounds[k];i!=bounds[k+1];++i) builder.add(words[i]);
+      builder.compact();
+    },1);
+    auto t1 = std::chrono::steady_clock::now();
+
+    merge(dfa,shards,empty);
+    shards.clear();
+    auto t2 = std::chrono::steady_clock::now();
+
+    Hopcroft minimize(Hopcroft::REVUZ);
+    minimize(dfa);
+    auto t3 = std::chrono::steady_clock::now();
+    build_seconds = std::chrono::duration<double>(t1 - t0).count();
+    merge_seconds = std::chrono::duration<double>(t2 - t1).count();
+    minimize_seconds = std::chrono::duration<double>(t3 - t2).count();
+  }
+
+  ///@brief Die Anzahl der Shards des letzten Aufbaus
+  unsigned shards() const{
+    return used;
+  }
+
+  ///@brief Die Dauer von Sortieren und Aufbau der Shards in Sekunden
+  double build_time() const{
+    return build_seconds;
+  }
+
+  ///@brief Die Dauer des Zusammenhängens in Sekunden
+  double merge_time() const{
+    return merge_seconds;
+  }
+
+  ///@brief Die Dauer der abschließenden Minimierung in Sekunden
+  double minimize_time() const{
+    return minimize_seconds;
+  }
+
+  private:
+
+  //Zerlegt die sortierten Wörter ab first in Bereiche, die nur an Wechseln des ersten Bytes enden
+  std::vector<std::size_t> split(const std::vector<std::string>& words, std::size_t first) const{
+    unsigned n = wanted ? wanted : Parallel::threads() * 4;
+    std::size_t target = (words.size() - first) / n + 1;
+    std::vector<std::size_t> bounds(1,first);
+    for(std::size_t i = first;i!=words.size();){
+      //Das Ende der Gruppe mit gleichem ersten Byte
+      char c = words[i][0];
+      std::size_t j = std::partition_point(words.begin()+i,words.end(),[c](const std::string& w){
+        return (unsigned char)w[0] <= (unsigned char)c;
+      }) - words.begin();
+      if(j - bounds.back() >= target || j == words.size()) bounds.push_back(j);
+      i = j;
+    }
+    return bounds;
+  }
+
+  //Hängt die Teilautomaten unter einen gemeinsamen Startzustand (Zustand 0)
+  void merge(DFA& dfa, std::vector<std::unique_ptr<DFA> >& shards, bool empty){
+    std::vector<unsigned> offset(shards.size());
+    unsigned n = 1;
+    std::size_t m = 0;
+    for(std::size_t k = 0;k!=shards.size();++k){
+      offset[k] = n;
+      n += shards[k]->state_count - 1;
+      m += shards[k]->transition_count;
+      for(unsigned i = 0;i!=shards[k]->alphabet.size();++i) dfa.alphabet.add(shards[k]->alphabet.symbol(i));
+    }
+    std::vector<Transitions::Arc> arcs;
+    arcs.reserve(m);
+    //Die Startzustände der Shards fallen mit dem gemeinsamen zusammen; ihre Zeilen
+    //folgen in Shard-Reihenfolge und damit nach dem ersten Byte sortiert aufeinander
+    for(std::size_t k = 0;k!=shards.size();++k){
+      const DFA& s = *shards[k];
+      for(unsigned i = 0;i!=s.state_count;++i){
+        for(unsigned j = s.transitions.begin(i);j!=s.transitions.end(i);++j){
+          Transitions::Arc arc;
+          arc.source = number(s,i,offset[k]);
+          arc.target = number(s,s.transitions.target(j),offset[k]);
+          arc.symbol = s.transitions.symbol(j);
+          arcs.push_back(arc);
+        }
+      }
+    }
+    dfa.transitions.assign(n,arcs);
+    dfa.state_count = n;
+    dfa.transition_count = arcs.size();
+    dfa.start_state = 0;
+    dfa.signatures.assign(n);
+    for(auto it = arcs.begin();it!=arcs.end();++it) dfa.signatures.add(it->source,dfa.alphabet[it->symbol]);
+    dfa.final_states.clear();
+    if(empty){
+      dfa.final_states.insert(0);
+      dfa.signatures.set_final(0);
+    }
+    for(std::size_t k = 0;k!=shards.size();++k){
+      const DFA& s = *shards[k];
+      for(auto it = s.final_states.begin();it!=s.final_states.end();++it){
+        unsigned f = number(s,*it,offset[k]);
+        dfa.final_states.insert(f);
+        dfa.signatures.set_final(f);
+      }
+    }
+  }
+
+  //Die Nummer eines Shard-Zustands im Gesamtautomaten, der Startzustand wird zu 0
+  static unsigned number(const DFA& s, unsigned state, unsigned offset){
+    if(state == s.start_state) return 0;
+    return offset + (state < s.start_state ? state : state - 1);
+  }
+
+  unsigned wanted; ///< Die gewünschte Anzahl an Shards, 0 = vier je Thread
+  unsigned used; ///< Die Anzahl der Shards des letzten Aufbaus
+  double build_seconds; ///< Die Dauer von Sortieren und Aufbau
+  double merge_seconds; ///< Die Dauer des Zusammenhängens
+  double minimize_seconds; ///< Die Dauer der abschließenden Minimierung
+
+};
+
+#endif
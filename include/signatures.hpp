@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////
+// signatures.hpp
+// Klasse für das Hopcroft Projekt
+// Symbolmengen und Endzustandsmarkierung aller Zustände als Bitvektoren
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SIGNATURES_HPP__
+#define __SIGNATURES_HPP__
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/** @brief Die Signaturen aller Zustände: für welche Symbole ein Zustand Übergänge
+           besitzt und ob er ein Endzustand ist
+
+    Jede Signatur ist ein Bitvektor aus 64-Bit-Wörtern; Bit 0 ist die
+    Endzustandsmarkierung, Bit i+1 steht für das Symbol mit dem Alphabetindex i.
+    Alle Signaturen liegen mit gleicher Breite hintereinander in einem Array.
+    Die Breite richtet sich nach dem größten bisher gesetzten Index: bei bis zu
+    63 Symbolen genügt ein Wort je Zustand, bei 256 Symbolen (alle Bytes) sind es fünf.
+    Wird ein größerer Index gesetzt, werden alle Signaturen einmal verbreitert.
+*/
+class Signatures{
+
+public:
+
+static constexpr unsigned MAX_SYMBOLS = 256; ///< Die größte Anzahl an Symbolen
+
+///@brief Der Konstruktor der Klasse
+Signatures(){
+  words = 1;
+  count = 0;
+}
+
+///@brief Die Anzahl der Signaturen
+unsigned size() const{
+  return count;
+}
+
+///@brief Die Anzahl der 64-Bit-Wörter je Signatur
+unsigned width() const{
+  return words;
+}
+
+///@brief Fügt eine leere Signatur hinzu
+void push_back(){
+  bits.resize(bits.size() + words,0);
+  ++count;
+}
+
+/** @brief Ändert die Anzahl der Signaturen, neue Signaturen sind leer
+    @param n die neue Anzahl
+*/
+void resize(unsigned n){
+  bits.resize((std::size_t)n * words,0);
+  count = n;
+}
+
+/** @brief Ersetzt alle Signaturen durch n leere
+    @param n die neue Anzahl
+*/
+void assign(unsigned n){
+  bits.assign((std::size_t)n * words,0);
+  count = n;
+}
+
+/** @brief Fügt der Signatur eines Zustands ein Symbol hinzu
+    @param state der Zustand
+    @param index der Alphabetindex des Symbols
+*/
+void add(unsigned state, unsigned index){
+  if(index >= MAX_SYMBOLS){
+    std::cerr << "Error: index is too big.\n";
+    return;
+  }
+  unsigned bit = index + 1;
+  if(bit / 64 >= words) widen(bit / 64 + 1);
+  bits[(std::size_t)state * words + bit / 64] |= std::uint64_t(1) << (bit % 64);
+}
+
+/** @brief Markiert die Signatur eines Zustands als Endzustand
+    @param state der Zustand
+*/
+void set_final(unsigned state){
+  bits[(std::size_t)state * words] |= 1;
+}
+
+/** @brief Leert die Signatur eines Zustands
+    @param state der Zustand
+*/
+void reset(unsigned state){
+  for(unsigned w = 0;w!=words;++w) bits[(std::size_t)state * words + w] = 0;
+}
+
+/** @brief Kopiert eine Signatur auf einen anderen Zustand
+    @param to der Zielzustand
+    @param from der Quellzustand
+*/
+void copy(unsigned to, unsigned from){
+  for(unsigned w = 0;w!=words;++w) bits[(std::size_t)to * words + w] = bits[(std::size_t)from * words + w];
+}
+
+/** @brief Die Signaturen der gegebenen Zustände in dieser Reihenfolge, für das Umnummerieren
+    @param states die Zustände
+*/
+Signatures select(const std::vector<unsigned>& states) const{
+  Signatures s;
+  s.words = words;
+  s.count = states.size();
+  s.bits.resize((std::size_t)s.count * words);
+  for(unsigned i = 0;i!=s.count;++i){
+    for(unsigned w = 0;w!=words;++w) s.bits[(std::size_t)i * words + w] = bits[(std::size_t)states[i] * words + w];
+  }
+  return s;
+}
+
+/** @brief Vergleicht zwei Signaturen wortweise
+    @return -1, 0 oder 1
+*/
+int compare(unsigned one, unsigned two) const{
+  const std::uint64_t* a = &bits[(std::size_t)one * words];
+  const std::uint64_t* b = &bits[(std::size_t)two * words];
+  for(unsigned w = 0;w!=words;++w){
+    if(a[w] != b[w]) return a[w] < b[w] ? -1 : 1;
+  }
+  return 0;
+}
+
+///@brief Prüft zwei Signaturen auf Gleichheit, mit AVX2 vier Wörter auf einmal
+bool equal(unsigned one, unsigned two) const{
+  const std::uint64_t* a = &bits[(std::size_t)one * words];
+  const std::uint64_t* b = &bits[(std::size_t)two * words];
+  unsigned w = 0;
+#ifdef __AVX2__
+  for(;w+4<=words;w+=4){
+    __m256i x = _mm256_loadu_si256((const __m256i*)(a+w));
+    __m256i y = _mm256_loadu_si256((const __m256i*)(b+w));
+    if(_mm256_movemask_epi8(_mm256_cmpeq_epi64(x,y)) != -1) return false;
+  }
+#endif
+  for(;w!=words;++w){
+    if(a[w] != b[w]) return false;
+  }
+  return true;
+}
+
+///@brief Der belegte Speicher in Bytes
+std::size_t memory() const{
+  return bits.capacity() * sizeof(std::uint64_t);
+}
+
+private:
+
+//Verbreitert alle Signaturen auf w Wörter
+void widen(unsigned w){
+  std::vector<std::uint64_t> wide((std::size_t)count * w,0);
+  for(unsigned i = 0;i!=count;++i){
+    for(unsigned k = 0;k!=words;++k) wide[(std::size_t)i * w + k] = bits[(std::size_t)i * words + k];
+  }
+  bits.swap(wide);
+  words = w;
+}
+
+std::vector<std::uint64_t> bits; ///< Die Bitvektoren aller Zustände, je words Wörter
+unsigned words; ///< Die Anzahl der Wörter je Signatur
+unsigned count; ///< Die Anzahl der Signaturen
+
+};
+
+#endif
@@ -0,0 +1,304 @@
+////////////////////////////////////////////////////////////////////////////////
+// subset.hpp
+// Klasse für das Hopcroft Projekt
+// Potenzmengenkonstruktion: vom NFA zum DFA
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SUBSET_HPP__
+#define __SUBSET_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include "DFA.hpp"
+#include "nfa.hpp"
+#include "parallel.hpp"
+
+/** @brief Bestimmt einen DFA zu einem NFA über die Potenzmengenkonstruktion
+
+    Jeder Zustand des DFA steht für eine (epsilon-abgeschlossene) Menge von
+    NFA-Zuständen. Die Mengen liegen sortiert hintereinander in einem gemeinsamen
+    Speicher (pool) und werden über eine Hashtabelle mit offener Adressierung
+    eindeutig gemacht (hash consing); gleiche Mengen werden also nur einmal
+    gespeichert und über ihre Nummer verglichen.
+
+    Die Konstruktion läuft in Ebenen einer Breitensuche. Da neue Zustände
+    fortlaufend nummeriert werden, ist jede Ebene ein Bereich von Nummern. Die
+    Nachfolgermengen einer Ebene werden in Blöcken parallel berechnet, danach in
+    Blockreihenfolge seriell eingetragen; die Nummerierung hängt damit nicht von
+    der Anzahl der Threads ab. Die leere Menge wird nicht angelegt, der DFA ist
+    also partiell. Das Ergebnis kann direkt mit Hopcroft minimiert werden.
+*/
+class SubsetConstruction{
+
+  public:
+
+  /** @brief Der Konstruktor der Klasse
+      @param l optional: die Höchstzahl an DFA-Zuständen, 0 = unbeschränkt. Default = 0
+  */
+  SubsetConstruction(unsigned l = 0){
+    limit = l;
+    input_states = 0;
+    output_states = 0;
+    largest = 0;
+    seconds = 0;
+  }
+
+  /** @brief Legt die Höchstzahl an DFA-Zuständen fest, schützt vor exponentiellem Wachstum
+      @param l die Höchstzahl, 0 = unbeschränkt
+  */
+  void set_limit(unsigned l){
+    limit = l;
+  }
+
+  /** @brief Bestimmt den DFA
+      @param nfa Der nichtdeterministische Automat
+      @param dfa Der Zielautomat, frisch mit DFA() erzeugt
+      @return false wenn die Höchstzahl an Zuständen überschritten wurde, der DFA bleibt dann unverändert
+  */
+  bool operator()(const NFA& nfa, DFA& dfa){
+    auto start = std::chrono::steady_clock::now();
+    input_states = nfa.state_count;
+    output_states = 0;
+    largest = 0;
+    pool.clear();
+    offsets.assign(1,0);
+    hashes.clear();
+    finals.clear();
+    table.assign(1024,NONE);
+    arcs.clear();
+
+    //Der Startzustand ist der Abschluss des NFA-Startzustands
+    scratch.resize(1);
+    prepare(scratch[0]);
+    scratch[0].set.assign(1,nfa.start_state);
+    closure(nfa,scratch[0]);
+    intern(nfa,scratch[0].set.data(),scratch[0].set.size());
+
+    bool ok = true;
+    for(unsigned level = 0;level!=output_states && ok;){
+      unsigned end = output_states;
+      unsigned blocks = std::min<unsigned>(Parallel::threads() * 4,(end - level + 63) / 64);
+      if(blocks > scratch.size()) scratch.resize(blocks);
+      Parallel::parallel_for(0,blocks,[&](int b){
+        Scratch& w = scratch[b];
+        prepare(w);
+        w.found.clear();
+        w.sets.clear();
+        unsigned first = level + (std::uint64_t)(end - level) * b / blocks;
+        unsigned last = level + (std::uint64_t)(end - level) * (b + 1) / blocks;
+        for(unsigned d = first;d!=last;++d) expand(nfa,d,w);
+      },1);
+      //Eintragen in Blockreihenfolge
+      for(unsigned b = 0;b!=blocks && ok;++b){
+        Scratch& w = scratch[b];
+        for(auto it = w.found.begin();it!=w.found.end();++it){
+          Transitions::Arc arc;
+          arc.source = it->source;
+          arc.symbol = it->symbol;
+          arc.target = intern(nfa,w.sets.data() + it->begin,it->end - it->begin);
+          arcs.push_back(arc);
+          if(limit && output_states > limit){
+            ok = false;
+            break;
+          }
+        }
+      }
+      level = end;
+    }
+    if(ok) build(dfa);
+    else std::cerr << "Error: the subset construction exceeds " << limit << " states.\n";
+
+    std::vector<unsigned>().swap(pool);
+    std::vector<std::size_t>().swap(offsets);
+    std::vector<std::uint64_t>().swap(hashes);
+    std::vector<unsigned>().swap(table);
+    std::vector<Transitions::Arc>().swap(arcs);
+    std::vector<Scratch>().swap(scratch);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ok;
+  }
+
+  ///@brief Die Anzahl der Zustände des NFA
+  unsigned nfa_states() const{
+    return input_states;
+  }
+
+  ///@brief Die Anzahl der Zustände des erzeugten DFA
+  unsigned dfa_states() const{
+    return output_states;
+  }
+
+  ///@brief Das Verhältnis der Zustände von DFA zu NFA
+  double blowup() const{
+    return input_states ? double(output_states) / input_states : 0;
+  }
+
+  ///@brief Die Größe der größten Zustandsmenge
+  std::size_t largest_set() const{
+    return largest;
+  }
+
+  ///@brief Die Dauer der letzten Konstruktion in Sekunden
+  double duration() const{
+    return seconds;
+  }
+
+  private:
+
+  static constexpr unsigned NONE = ~0u; ///< Freier Platz in der Hashtabelle
+
+  ///	@brief Eine gefundene Nachfolgermenge, die Menge liegt in Scratch::sets
+  struct Found{
+    unsigned source; ///< Der DFA-Zustand
+    char symbol; ///< Das Symbol
+    std::size_t begin; ///< Der Anfang der Menge
+    std::size_t end; ///< Das Ende der Menge
+  };
+
+  ///	@brief Die Hilfsvektoren eines Blocks
+  struct Scratch{
+    std::vector<unsigned> mark; ///< Der Stempel je NFA-Zustand beim Abschluss
+    unsigned stamp; ///< Der aktuelle Stempel
+    std::vector<std::pair<unsigned char,unsigned> > moves; ///< Symbol und Ziel aller Übergänge einer Menge
+    std::vector<unsigned> set; ///< Die gerade berechnete Menge
+    std::vector<unsigned> stack; ///< Der Stapel beim Abschluss
+    std::vector<unsigned> sets; ///< Die gefundenen Mengen hintereinander
+    std::vector<Found> found; ///< Die gefundenen Nachfolger
+  };
+
+  //Bereitet die Stempel eines Blocks für den NFA vor
+  void prepare(Scratch& w) const{
+    if(w.mark.size() != input_states){
+      w.mark.assign(input_states,0);
+      w.stamp = 0;
+    }
+  }
+
+  //Erweitert w.set um alle über Epsilon-Übergänge erreichbaren Zustände und sortiert die Menge
+  static void closure(const NFA& nfa, Scratch& w){
+    if(++w.stamp == 0){
+      std::fill(w.mark.begin(),w.mark.end(),0);
+      w.stamp = 1;
+    }
+    w.stack.clear();
+    for(auto it = w.set.begin();it!=w.set.end();++it){
+      w.mark[*it] = w.stamp;
+      w.stack.push_back(*it);
+    }
+    if(!nfa.epsilon_targets.empty()){
+      while(!w.stack.empty()){
+        unsigned s = w.stack.back();
+        w.stack.pop_back();
+        for(unsigned j = nfa.epsilon_first[s];j!=nfa.epsilon_first[s+1];++j){
+          unsigned t = nfa.epsilon_targets[j];
+          if(w.mark[t] == w.stamp) continue;
+          w.mark[t] = w.stamp;
+          w.set.push_back(t);
+          w.stack.push_back(t);
+        }
+      }
+    }
+    std::sort(w.set.begin(),w.set.end());
+  }
+
+  //Berechnet alle Nachfolgermengen eines DFA-Zustands
+  void expand(const NFA& nfa, unsigned d, Scratch& w) const{
+    w.moves.clear();
+    for(std::size_t i = offsets[d];i!=offsets[d+1];++i){
+      unsigned s = pool[i];
+      for(unsigned j = nfa.first[s];j!=nfa.first[s+1];++j){
+        w.moves.push_back(std::make_pair((unsigned char)nfa.arcs[j].symbol,nfa.arcs[j].target));
+      }
+    }
+    std::sort(w.moves.begin(),w.moves.end());
+    for(std::size_t i = 0;i!=w.moves.size();){
+      unsigned char c = w.moves[i].first;
+      w.set.clear();
+      for(;i!=w.moves.size() && w.moves[i].first == c;++i){
+        if(w.set.empty() || w.set.back() != w.moves[i].second) w.set.push_back(w.moves[i].second);
+      }
+      closure(nfa,w);
+      Found f;
+      f.source = d;
+      f.symbol = (char)c;
+      f.begin = w.sets.size();
+      w.sets.insert(w.sets.end(),w.set.begin(),w.set.end());
+      f.end = w.sets.size();
+      w.found.push_back(f);
+    }
+  }
+
+  //Die Nummer einer Menge, legt sie bei Bedarf als neuen DFA-Zustand an
+  unsigned intern(const NFA& nfa, const unsigned* set, std::size_t size){
+    std::uint64_t h = 0x9e3779b97f4a7c15ULL ^ size;
+    for(std::size_t i = 0;i!=size;++i){
+      h ^= set[i];
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 32;
+    }
+    std::size_t mask = table.size() - 1;
+    for(std::size_t slot = h & mask;;slot = (slot + 1) & mask){
+      unsigned d = table[slot];
+      if(d == NONE){
+        d = output_states++;
+        table[slot] = d;
+        hashes.push_back(h);
+        bool final = false;
+        for(std::size_t i = 0;i!=size;++i) final = final || nfa.final[set[i]];
+        finals.push_back(final);
+        pool.insert(pool.end(),set,set + size);
+        offsets.push_back(pool.size());
+        if(size > largest) largest = size;
+        if(2 * output_states > table.size()) grow();
+        return d;
+      }
+      if(hashes[d] == h && offsets[d+1] - offsets[d] == size && std::equal(set,set + size,pool.begin() + offsets[d])) return d;
+    }
+  }
+
+  //Verdoppelt die Hashtabelle
+  void grow(){
+    table.assign(table.size() * 2,NONE);
+    std::size_t mask = table.size() - 1;
+    for(unsigned d = 0;d!=output_states;++d){
+      std::size_t slot = hashes[d] & mask;
+      while(table[slot] != NONE) slot = (slot + 1) & mask;
+      table[slot] = d;
+    }
+  }
+
+  //Schreibt die gefundenen Zustände und Übergänge in den DFA
+  void build(DFA& dfa) const{
+    for(auto it = arcs.begin();it!=arcs.end();++it) dfa.alphabet.add(it->symbol);
+    dfa.transitions.assign(output_states,arcs);
+    dfa.state_count = output_states;
+    dfa.transition_count = arcs.size();
+    dfa.start_state = 0;
+    dfa.signatures.assign(output_states);
+    for(auto it = arcs.begin();it!=arcs.end();++it) dfa.signatures.add(it->source,dfa.alphabet[it->symbol]);
+    dfa.final_states.clear();
+    for(unsigned d = 0;d!=output_states;++d){
+      if(!finals[d]) continue;
+      dfa.final_states.insert(d);
+      dfa.signatures.set_final(d);
+    }
+  }
+
+  unsigned limit; ///< Die Höchstzahl an DFA-Zuständen, 0 = unbeschränkt
+  unsigned input_states; ///< Die Anzahl der NFA-Zustände
+  unsigned output_states; ///< Die Anzahl der DFA-Zustände
+  std::size_t largest; ///< Die Größe der größten Menge
+  double seconds; ///< Die Dauer der letzten Konstruktion
+  std::vector<unsigned> pool; ///< Die Mengen aller DFA-Zustände hintereinander
+  std::vector<std::size_t> offsets; ///< Der Anfang der Menge je DFA-Zustand, plus Ende
+  std::vector<std::uint64_t> hashes; ///< Der Hashwert der Menge je DFA-Zustand
+  std::vector<bool> finals; ///< Markiert die DFA-Endzustände
+  std::vector<unsigned> table; ///< Die Hashtabelle (offene Adressierung) der DFA-Zustände
+  std::vector<Transitions::Arc> arcs; ///< Die Übergänge des DFA
+  std::vector<Scratch> scratch; ///< Die Hilfsvektoren je Block
+
+};
+
+#endif
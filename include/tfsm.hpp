@@ -0,0 +1,330 @@
+////////////////////////////////////////////////////////////////////////////////
+// tfsm.hpp
+// Klasse für das Hopcroft Projekt
+// Schnelles Einlesen von Automaten im AT&T-Format (tfsm)
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __TFSM_HPP__
+#define __TFSM_HPP__
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <chrono>
+#include <map>
+#include <iterator>
+#include "DFA.hpp"
+#include "mapped_file.hpp"
+#include "parallel.hpp"
+
+/** @brief Klasse zum Einlesen großer Dateien in FSM2's at&t-Format
+
+    Die Datei wird mit mmap eingeblendet und an Zeilengrenzen in Stücke zerlegt,
+    die parallel geparst werden. Zahlen werden ohne Zwischenstrings direkt aus
+    dem Puffer gelesen. Die Übergänge aller Stücke werden anschließend in einem
+    Zug in die kompakte Übergangsspeicherung des DFA geschrieben.
+
+    Felder sind durch Tabulatoren getrennt, ein '\r' am Zeilenende wird ignoriert.
+    Zeilen mit drei oder mehr Feldern sind Übergänge (Quelle, Ziel, Eingabesymbol,
+    optional Ausgabesymbol und Gewicht), Zeilen mit einem oder zwei Feldern sind
+    Endzustände (Zustand, optional Gewicht). Gewichte werden ignoriert.
+    Der Startzustand ist die Quelle des ersten Übergangs.
+
+    Symbole sind Bytes. Besteht ein Eingabesymbol aus mehreren Bytes (z.B. ein
+    UTF-8-Zeichen außerhalb von ASCII), wird der Übergang in eine Kette von
+    Byte-Übergängen über neue Zwischenzustände zerlegt. Gleiche Anfänge von
+    derselben Quelle teilen sich die Zwischenzustände, der Automat bleibt also
+    deterministisch.
+*/
+class TfsmReader{
+
+  //ExternalMinimizer parst die Datei stückweise mit parse
+  friend class ExternalMinimizer;
+  //ebenso das Einlesen nichtdeterministischer Automaten
+  friend class NFA;
+  //und der Konstruktor DFA(std::ifstream&)
+  friend class DFA;
+
+  public:
+
+  ///@brief Der Konstruktor der Klasse
+  TfsmReader(){
+    bytes = 0;
+    seconds = 0;
+    malformed = 0;
+    duplicates = 0;
+  }
+
+  /** @brief Liest einen Automaten ein
+      @param dfa Der Zielautomat, frisch mit DFA() erzeugt
+      @param filename Der Name der Datei
+      @return false wenn die Datei nicht geöffnet werden konnte
+  */
+  bool operator()(DFA& dfa, const std::string& filename){
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file;
+    if(!file.open(filename)) return false;
+    bytes = file.size();
+
+    //Zerlegung an Zeilengrenzen, mehrere Stücke je Thread
+    const char* data = file.data();
+    std::size_t size = file.size();
+    unsigned count = size < (1u << 20) ? 1 : Parallel::threads() * 4;
+    std::vector<const char*> bounds(count+1,data+size);
+    bounds[0] = data;
+    for(unsigned c = 1;c!=count;++c){
+      const char* p = data + size / count * c;
+      if(p < bounds[c-1]) p = bounds[c-1];
+      const char* nl = static_cast<const char*>(memchr(p,'\n',data+size-p));
+      bounds[c] = nl ? nl+1 : data+size;
+    }
+    std::vector<Chunk> chunks(count);
+    Parallel::parallel_for(0,count,[&](int c){
+      parse(bounds[c],bounds[c+1],chunks[c]);
+    },1);
+
+    duplicates = build(dfa,chunks,malformed);
+
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(malformed) std::cerr << "Warning: " << malformed << " malformed lines in " << filename << " were skipped.\n";
+    if(duplicates) std::cerr << "Warning: " << duplicates << " transitions in " << filename << " share source and symbol with another one, "
+                             << "the automaton is nondeterministic and only the last of each was kept (see NFA).\n";
+    return true;
+  }
+
+  ///@brief Der Durchsatz des letzten Einlesens in MB/s
+  double throughput() const{
+    return seconds > 0 ? bytes / 1e6 / seconds : 0;
+  }
+
+  ///@brief Die Dauer des letzten Einlesens in Sekunden
+  double duration() const{
+    return seconds;
+  }
+
+  ///@brief Die Anzahl übersprungener fehlerhafter Zeilen
+  std::size_t malformed_lines() const{
+    return malformed;
+  }
+
+  ///@brief Die Anzahl doppelter Übergänge (gleiche Quelle, gleiches Symbol), von denen nur der letzte übernommen wurde
+  std::size_t duplicate_arcs() const{
+    return duplicates;
+  }
+
+  private:
+
+  ///	@brief Ein Übergang mit einem Symbol aus mehreren Bytes
+  struct LongArc{
+    unsigned source; ///< Der Ausgangszustand
+    unsigned target; ///< Der Zielzustand
+    std::string label; ///< Die Bytes des Symbols
+  };
+
+  ///	@brief Das Ergebnis eines geparsten Stücks
+  struct Chunk{
+    Chunk(){
+      states = 0;
+      malformed = 0;
+      has_start = false;
+      for(int i = 0;i!=256;++i) seen[i] = false;
+    }
+    std::vector<Transitions::Arc> arcs; ///< Die Übergänge in Dateireihenfolge
+    std::vector<LongArc> long_arcs; ///< Die Übergänge mit Mehrbyte-Symbolen
+    std::vector<unsigned> finals; ///< Die Endzustände in Dateireihenfolge
+    std::string symbols; ///< Die Symbole in der Reihenfolge ihres ersten Auftretens
+    bool seen[256]; ///< Markiert bereits gesehene Symbole
+    unsigned states; ///< Größte Zustandsnummer + 1
+    unsigned start; ///< Die Quelle des ersten Übergangs
+    bool has_start; ///< true wenn das Stück einen Übergang enthält
+    std::size_t malformed; ///< Anzahl fehlerhafter Zeilen
+  };
+
+  /** @brief Baut den Automaten aus den geparsten Stücken auf, gemeinsam für operator() und DFA(std::ifstream&)
+      @param dfa Der Zielautomat, frisch mit DFA() erzeugt
+      @param chunks Die Stücke in Dateireihenfolge, ihre Übergänge werden dabei freigegeben
+      @param malformed Die Anzahl fehlerhafter Zeilen aller Stücke
+      @return die Anzahl doppelter Übergänge, von denen nur der letzte übernommen wurde
+  */
+  static std::size_t build(DFA& dfa, std::vector<Chunk>& chunks, std::size_t& malformed){
+    //Zusammenführen in Dateireihenfolge
+    std::size_t arc_count = 0;
+    unsigned state_count = 1;
+    bool have_start = false;
+    unsigned start_state = 0;
+    malformed = 0;
+    for(auto it = chunks.begin();it!=chunks.end();++it){
+      arc_count += it->arcs.size();
+      if(it->states > state_count) state_count = it->states;
+      malformed += it->malformed;
+      if(!have_start && it->has_start){
+        have_start = true;
+        start_state = it->start;
+      }
+      //Alphabetsymbole in der Reihenfolge ihres ersten Auftretens
+      for(auto c = it->symbols.begin();c!=it->symbols.end();++c) dfa.alphabet.add(*c);
+    }
+    if(!have_start){
+      for(auto it = chunks.begin();it!=chunks.end();++it){
+        if(!it->finals.empty()){
+          start_state = it->finals.front();
+          break;
+        }
+      }
+    }
+    std::vector<Transitions::Arc> arcs;
+    arcs.reserve(arc_count);
+    for(auto it = chunks.begin();it!=chunks.end();++it){
+      arcs.insert(arcs.end(),it->arcs.begin(),it->arcs.end());
+      std::vector<Transitions::Arc>().swap(it->arcs);
+    }
+    //Mehrbyte-Symbole werden zu Ketten, die Zwischenzustände folgen auf die Zustände der Datei
+    std::map<std::pair<unsigned,std::string>,unsigned> chains;
+    for(auto it = chunks.begin();it!=chunks.end();++it){
+      for(auto l = it->long_arcs.begin();l!=it->long_arcs.end();++l){
+        unsigned state = l->source;
+        for(std::size_t k = 0;k+1<l->label.size();++k){
+          auto key = std::make_pair(l->source,l->label.substr(0,k+1));
+          auto c = chains.find(key);
+          if(c == chains.end()){
+            c = chains.insert(std::make_pair(key,state_count++)).first;
+            Transitions::Arc arc;
+            arc.source = state;
+            arc.target = c->second;
+            arc.symbol = l->label[k];
+            arcs.push_back(arc);
+          }
+          state = c->second;
+        }
+        Transitions::Arc arc;
+        arc.source = state;
+        arc.target = l->target;
+        arc.symbol = l->label[l->label.size()-1];
+        arcs.push_back(arc);
+      }
+    }
+
+    //Aufbau des Automaten
+    std::size_t duplicates = dfa.transitions.assign(state_count,arcs);
+    dfa.state_count = state_count;
+    dfa.start_state = start_state;
+    dfa.transition_count = dfa.transitions.edges();
+    dfa.signatures.assign(state_count);
+    for(unsigned i = 0;i!=state_count;++i){
+      for(unsigned j = dfa.transitions.begin(i);j!=dfa.transitions.end(i);++j){
+        dfa.signatures.add(i,dfa.alphabet[dfa.transitions.symbol(j)]);
+      }
+    }
+    dfa.final_states.clear();
+    for(auto it = chunks.begin();it!=chunks.end();++it){
+      for(auto f = it->finals.begin();f!=it->finals.end();++f){
+        if(dfa.final_states.insert(*f).second) dfa.signatures.set_final(*f);
+      }
+    }
+    return duplicates;
+  }
+
+  /// @brief Liest eine vorzeichenlose Zahl, die genau das Feld [p,end) ausfüllt
+  static bool scan_unsigned(const char* p, const char* end, unsigned& value){
+    if(p == end) return false;
+    unsigned long long v = 0;
+    for(;p!=end;++p){
+      unsigned d = (unsigned char)*p - '0';
+      if(d > 9) return false;
+      v = v * 10 + d;
+      if(v >= 0xffffffffULL) return false;
+    }
+    value = (unsigned)v;
+    return true;
+  }
+
+  /// @brief Parst alle Zeilen aus [p,end)
+  static void parse(const char* p, const char* end, Chunk& chunk){
+    const char* field_begin[3];
+    const char* field_end[3];
+    while(p < end){
+      const char* line_end = static_cast<const char*>(memchr(p,'\n',end-p));
+      if(!line_end) line_end = end;
+      const char* q = p;
+      p = line_end + 1;
+      //Zeilenende im Windows-Format
+      if(line_end != q && line_end[-1] == '\r') --line_end;
+      //Leerzeilen werden übersprungen
+      if(q == line_end) continue;
+      //Felder sind wie beim Einlesen mit DFA(std::ifstream&) nur durch Tabulatoren getrennt,
+      //ein Leerzeichen ist also ein gültiges Symbol; nur die ersten drei werden gebraucht
+      unsigned fields = 0;
+      while(true){
+        const char* f = q;
+        while(q != line_end && *q != '\t') ++q;
+        if(fields < 3){
+          field_begin[fields] = f;
+          field_end[fields] = q;
+        }
+        ++fields;
+        if(q == line_end) break;
+        ++q;
+      }
+      unsigned source, target;
+      if(!scan_unsigned(field_begin[0],field_end[0],source)){
+        ++chunk.malformed;
+        continue;
+      }
+      if(source >= chunk.states) chunk.states = source + 1;
+      if(fields <= 2){
+        //Endzustand, optional mit Gewicht
+        chunk.finals.push_back(source);
+        continue;
+      }
+      if(!scan_unsigned(field_begin[1],field_end[1],target) || field_begin[2] == field_end[2]){
+        ++chunk.malformed;
+        continue;
+      }
+      if(target >= chunk.states) chunk.states = target + 1;
+      if(!chunk.has_start){
+        chunk.has_start = true;
+        chunk.start = source;
+      }
+      if(field_end[2] - field_begin[2] == 1){
+        Transitions::Arc arc;
+        arc.source = source;
+        arc.target = target;
+        arc.symbol = *field_begin[2];
+        chunk.arcs.push_back(arc);
+      }
+      else{
+        LongArc arc;
+        arc.source = source;
+        arc.target = target;
+        arc.label.assign(field_begin[2],field_end[2]);
+        chunk.long_arcs.push_back(arc);
+      }
+      for(const char* c = field_begin[2];c!=field_end[2];++c){
+        if(!chunk.seen[(unsigned char)*c]){
+          chunk.seen[(unsigned char)*c] = true;
+          chunk.symbols += *c;
+        }
+      }
+    }
+  }
+
+  std::size_t bytes; ///< Die Größe der zuletzt gelesenen Datei
+  double seconds; ///< Die Dauer des letzten Einlesens
+  std::size_t malformed; ///< Anzahl fehlerhafter Zeilen
+  std::size_t duplicates; ///< Anzahl doppelter Übergänge
+
+};
+
+inline DFA::DFA(std::ifstream& in){
+  init();
+  std::string buffer((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+  std::vector<TfsmReader::Chunk> chunks(1);
+  TfsmReader::parse(buffer.data(),buffer.data()+buffer.size(),chunks[0]);
+  std::size_t malformed = 0;
+  std::size_t duplicates = TfsmReader::build(*this,chunks,malformed);
+  if(malformed) std::cerr << "Warning: " << malformed << " malformed lines were skipped.\n";
+  if(duplicates) std::cerr << "Warning: " << duplicates << " transitions share source and symbol with another one, "
+                           << "the automaton is nondeterministic and only the last of each was kept (see NFA).\n";
+}
+
+#endif
@@ -0,0 +1,400 @@
+////////////////////////////////////////////////////////////////////////////////
+// transitions.hpp
+// Klasse für das Hopcroft Projekt
+// Kompakte Speicherung der Übergänge eines Automaten
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __TRANSITIONS_HPP__
+#define __TRANSITIONS_HPP__
+
+#include <vector>
+#include <cstddef>
+
+/** @brief Klasse zur zusammenhängenden Speicherung der Übergänge aller Zustände
+
+    Die Übergänge liegen CSR-artig in zwei flachen Arrays (Symbole und Zielzustände),
+    jede Zeile (= die Übergänge eines Zustands) ist nach Symbolen sortiert.
+    Da Wörter nachträglich eingefügt werden können, hat jede Zeile eine Kapazität.
+    Ist sie erschöpft, wird die Zeile ans Ende der Arrays verschoben; den dabei
+    entstehenden Verschnitt räumt compact() wieder auf.
+*/
+class Transitions{
+
+public:
+
+static constexpr unsigned NONE = ~0u; ///< Rückgabewert von find() wenn es keinen Übergang gibt
+
+///@brief Der Konstruktor der Klasse
+Transitions(){
+  count = 0;
+  waste = 0;
+}
+
+///	@brief Ein einzelner Übergang, für den Aufbau aller Zeilen auf einmal
+struct Arc{
+  unsigned source; ///< Der Ausgangszustand
+  unsigned target; ///< Der Zielzustand
+  char symbol; ///< Das Symbol
+};
+
+///@brief Die Anzahl der Zustände
+unsigned size() const{
+  return rows.size();
+}
+
+///@brief Die Anzahl der gespeicherten Übergänge
+std::size_t edges() const{
+  return count;
+}
+
+///@brief Fügt einen Zustand ohne Übergänge hinzu
+void push_back(){
+  Row r;
+  r.offset = symbols.size();
+  r.size = 0;
+  r.capacity = 0;
+  rows.push_back(r);
+}
+
+/** @brief Vergrößert die Anzahl der Zustände auf n, neue Zustände haben keine Übergänge
+    @param n die neue Anzahl an Zuständen
+*/
+void resize(unsigned n){
+  while(rows.size() < n) push_back();
+}
+
+/** @brief Hängt einen Übergang an die Zeile des zuletzt angelegten Zustands an, ohne zu suchen.
+           Damit lassen sich alle Zeilen in einem Durchlauf ohne Verschnitt aufbauen.
+    @param c das Symbol, muss größer sein als die bisherigen Symbole der Zeile
+    @param t der Zielzustand
+*/
+void append(char c, unsigned t){
+  Row& r = rows.back();
+  symbols.push_back(c);
+  targets.push_back(t);
+  ++r.size;
+  ++r.capacity;
+  ++count;
+}
+
+/** @brief Reserviert Platz für Zustände und Übergänge
+    @param states die erwartete Anzahl an Zuständen
+    @param transitions die erwartete Anzahl an Übergängen
+*/
+void reserve(unsigned states, std::size_t transitions){
+  rows.reserve(states);
+  symbols.reserve(transitions);
+  targets.reserve(transitions);
+}
+
+///@brief Entfernt alle Zustände und Übergänge
+void clear(){
+  rows.clear();
+  symbols.clear();
+  targets.clear();
+  count = 0;
+  waste = 0;
+}
+
+///@brief Position des ersten Übergangs eines Zustands in symbols/targets
+unsigned begin(unsigned state) const{
+  return rows[state].offset;
+}
+
+///@brief Position hinter dem letzten Übergang eines Zustands
+unsigned end(unsigned state) const{
+  return rows[state].offset + rows[state].size;
+}
+
+///@brief Die Anzahl der Übergänge eines Zustands
+unsigned degree(unsigned state) const{
+  return rows[state].size;
+}
+
+///@brief Das Symbol an Position pos
+char symbol(unsigned pos) const{
+  return symbols[pos];
+}
+
+///@brief Der Zielzustand an Position pos
+unsigned target(unsigned pos) const{
+  return targets[pos];
+}
+
+/** @brief Sucht den Übergang eines Zustands mit einem Symbol
+    @param state der Ausgangszustand
+    @param c das Symbol
+    @return der Zielzustand oder NONE
+*/
+unsigned find(unsigned state, char c) const{
+  const Row& r = rows[state];
+  //Die Zeilen sind kurz, daher genügt eine lineare Suche
+  for(unsigned i = r.offset; i != r.offset + r.size; ++i){
+    if(symbols[i] == c) return targets[i];
+    if(less(c, symbols[i])) break;
+  }
+  return NONE;
+}
+
+/** @brief Setzt einen Übergang. Existiert bereits ein Übergang mit dem Symbol,
+           wird sein Ziel überschrieben.
+    @param state der Ausgangszustand
+    @param c das Symbol
+    @param t der Zielzustand
+    @return true wenn der Übergang neu ist
+*/
+bool set(unsigned state, char c, unsigned t){
+  unsigned pos = rows[state].offset;
+  unsigned stop = pos + rows[state].size;
+  while(pos != stop && less(symbols[pos], c)) ++pos;
+  if(pos != stop && symbols[pos] == c){
+    targets[pos] = t;
+    return false;
+  }
+  //Einfügeposition relativ zum Zeilenanfang merken, da die Zeile verschoben werden kann
+  unsigned k = pos - rows[state].offset;
+  grow(state);
+  Row& r = rows[state];
+  for(unsigned i = r.offset + r.size; i != r.offset + k; --i){
+    symbols[i] = symbols[i-1];
+    targets[i] = targets[i-1];
+  }
+  symbols[r.offset + k] = c;
+  targets[r.offset + k] = t;
+  ++r.size;
+  ++count;
+  return true;
+}
+
+/** @brief Entfernt alle Übergänge eines Zustands. Die Kapazität der Zeile
+           bleibt erhalten, so dass der Zustand wiederverwendet werden kann.
+*/
+void reset(unsigned state){
+  count -= rows[state].size;
+  rows[state].size = 0;
+}
+
+/** @brief Entfernt den Übergang eines Zustands mit einem Symbol
+    @return true wenn es den Übergang gab
+*/
+bool erase(unsigned state, char c){
+  Row& r = rows[state];
+  for(unsigned i = r.offset; i != r.offset + r.size; ++i){
+    if(symbols[i] == c){
+      for(unsigned j = i + 1; j != r.offset + r.size; ++j){
+        symbols[j-1] = symbols[j];
+        targets[j-1] = targets[j];
+      }
+      --r.size;
+      --count;
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @brief Ersetzt alle Übergänge durch die gegebenen und baut die Zeilen in einem Zug
+           (Counting Sort nach Ausgangszustand) ohne Verschnitt auf.
+           Gibt es mehrere Übergänge mit gleichem Ausgangszustand und Symbol,
+           gewinnt der letzte in arcs.
+    @param states die Anzahl der Zustände; alle Zustände in arcs müssen kleiner sein
+    @param arcs die Übergänge
+    @return die Anzahl der verworfenen doppelten Übergänge
+*/
+std::size_t assign(unsigned states, const std::vector<Arc>& arcs){
+  rows.assign(states,Row());
+  for(auto it = arcs.begin();it!=arcs.end();++it) ++rows[it->source].size;
+  unsigned offset = 0;
+  for(auto it = rows.begin();it!=rows.end();++it){
+    it->offset = offset;
+    offset += it->size;
+    it->size = 0;
+  }
+  symbols.resize(arcs.size());
+  targets.resize(arcs.size());
+  for(auto it = arcs.begin();it!=arcs.end();++it){
+    Row& r = rows[it->source];
+    //Einfügen in die sortierte Zeile, bei gleichem Symbol hinter den vorhandenen
+    unsigned i = r.offset + r.size;
+    while(i != r.offset && less(it->symbol,symbols[i-1])){
+      symbols[i] = symbols[i-1];
+      targets[i] = targets[i-1];
+      --i;
+    }
+    symbols[i] = it->symbol;
+    targets[i] = it->target;
+    ++r.size;
+  }
+  //Doppelte entfernen: von gleichen Symbolen bleibt der letzte
+  std::size_t duplicates = 0;
+  unsigned out = 0;
+  for(auto it = rows.begin();it!=rows.end();++it){
+    unsigned begin = it->offset;
+    unsigned end = begin + it->size;
+    it->offset = out;
+    for(unsigned i = begin;i!=end;++i){
+      if(i + 1 != end && symbols[i+1] == symbols[i]){
+        ++duplicates;
+        continue;
+      }
+      symbols[out] = symbols[i];
+      targets[out] = targets[i];
+      ++out;
+    }
+    it->size = it->capacity = out - it->offset;
+  }
+  symbols.resize(out);
+  targets.resize(out);
+  count = out;
+  waste = 0;
+  return duplicates;
+}
+
+///@brief Schreibt alle Zeilen ohne Verschnitt hintereinander
+void compact(){
+  if(symbols.size() == count){
+    symbols.shrink_to_fit();
+    targets.shrink_to_fit();
+    return;
+  }
+  std::vector<char> new_symbols;
+  std::vector<unsigned> new_targets;
+  new_symbols.reserve(edges());
+  new_targets.reserve(edges());
+  for(auto it = rows.begin(); it != rows.end(); ++it){
+    unsigned offset = new_symbols.size();
+    new_symbols.insert(new_symbols.end(), symbols.begin() + it->offset, symbols.begin() + it->offset + it->size);
+    new_targets.insert(new_targets.end(), targets.begin() + it->offset, targets.begin() + it->offset + it->size);
+    it->offset = offset;
+    it->capacity = it->size;
+  }
+  symbols.swap(new_symbols);
+  targets.swap(new_targets);
+  waste = 0;
+}
+
+///@brief Der belegte Speicher in Bytes
+std::size_t memory() const{
+  return rows.capacity() * sizeof(Row)
+       + symbols.capacity() * sizeof(char)
+       + targets.capacity() * sizeof(unsigned);
+}
+
+private:
+
+///	@brief Eine Zeile: Lage und Größe der Übergänge eines Zustands
+struct Row{
+  Row(){
+    offset = size = capacity = 0;
+  }
+  unsigned offset; ///< Position des ersten Übergangs
+  unsigned size; ///< Anzahl der Übergänge
+  unsigned capacity; ///< Reservierter Platz
+};
+
+//Vergleich als unsigned char, damit die Reihenfolge der Bytereihenfolge entspricht
+static bool less(char a, char b){
+  return (unsigned char)a < (unsigned char)b;
+}
+
+//Sorgt dafür, dass in der Zeile eines Zustands Platz für einen weiteren Übergang ist
+void grow(unsigned state){
+  Row& r = rows[state];
+  if(r.size < r.capacity) return;
+  //Liegt die Zeile am Ende, kann sie einfach verlängert werden
+  if(r.offset + r.capacity == symbols.size()){
+    symbols.push_back(0);
+    targets.push_back(0);
+    ++r.capacity;
+    return;
+  }
+  //Ist der Verschnitt größer als die Nutzdaten, wird vorher aufgeräumt
+  if(waste > count){
+    compact();
+    if(r.offset + r.capacity == symbols.size()){
+      symbols.push_back(0);
+      targets.push_back(0);
+      ++r.capacity;
+      return;
+    }
+  }
+  //andernfalls wird sie mit doppelter Kapazität ans Ende verschoben
+  unsigned capacity = r.capacity < 2 ? 2 : 2 * r.capacity;
+  unsigned offset = symbols.size();
+  symbols.resize(offset + capacity, 0);
+  targets.resize(offset + capacity, 0);
+  for(unsigned i = 0; i != r.size; ++i){
+    symbols[offset + i] = symbols[r.offset + i];
+    targets[offset + i] = targets[r.offset + i];
+  }
+  waste += r.capacity;
+  r.offset = offset;
+  r.capacity = capacity;
+}
+
+std::vector<Row> rows; ///< Die Zeilen aller Zustände
+std::vector<char> symbols; ///< Die Symbole aller Übergänge, zeilenweise sortiert
+std::vector<unsigned> targets; ///< Die Zielzustände aller Übergänge
+std::size_t count; ///< Anzahl der Übergänge
+std::size_t waste; ///< Anzahl der Plätze in verlassenen Zeilen
+
+};
+
+/** @brief Dichte Übergangstabelle für kleine Alphabete
+
+    Jeder Zustand erhält eine Zeile mit einem Eintrag je Alphabetindex, so dass ein
+    Übergang ohne Suche mit einem einzigen Zugriff gefunden wird. Lohnt sich nur,
+    solange Zustände mal Alphabetgröße klein bleibt.
+*/
+class DenseTransitions{
+
+public:
+
+///@brief Der Konstruktor der Klasse
+DenseTransitions(){
+  columns = 0;
+}
+
+/** @brief Baut die Tabelle aus den kompakten Übergängen auf
+    @param t die Übergänge
+    @param width die Anzahl der Spalten (Alphabetgröße)
+    @param index ein Funktionsobjekt das einem Symbol seine Spalte zuordnet
+    @param sink optional: eine Senke als Ziel fehlender Übergänge statt Transitions::NONE.
+           Die Tabelle erhält dann sink+1 Zeilen, die Zeile der Senke führt in sich selbst,
+           so dass ein Lauf über ein Wort ohne Abfrage von NONE auskommt
+*/
+template<class Index>
+void build(const Transitions& t, unsigned width, Index index, unsigned sink = Transitions::NONE){
+  columns = width;
+  unsigned rows = sink == Transitions::NONE ? t.size() : sink + 1;
+  table.assign((std::size_t)rows * width, sink);
+  for(unsigned s = 0; s != t.size() && s != sink; ++s){
+    for(unsigned j = t.begin(s); j != t.end(s); ++j){
+      table[(std::size_t)s * width + index(t.symbol(j))] = t.target(j);
+    }
+  }
+}
+
+///@brief Der Zielzustand von state mit dem Symbol der Spalte i oder Transitions::NONE
+unsigned operator()(unsigned state, unsigned i) const{
+  return table[(std::size_t)state * columns + i];
+}
+
+///@brief Die Anzahl der Spalten
+unsigned width() const{
+  return columns;
+}
+
+///@brief Der belegte Speicher in Bytes
+std::size_t memory() const{
+  return table.capacity() * sizeof(unsigned);
+}
+
+private:
+
+std::vector<unsigned> table; ///< Die Zielzustände, zeilenweise
+unsigned columns; ///< Die Anzahl der Spalten
+
+};
+
+#endif
@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////
+// trim.hpp
+// Klasse für das Hopcroft Projekt
+// Entfernen unerreichbarer und toter Zustände vor der Minimierung
+////////////////////////////////////////////////////////////////////////////////
+
+//Vor dem Include-Guard, da DFA.hpp diese Datei vor hopcroft.hpp einbindet
+#include "DFA.hpp"
+
+#ifndef __TRIM_HPP__
+#define __TRIM_HPP__
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include "parallel.hpp"
+
+/** @brief Entfernt Zustände, die vom Startzustand aus nicht erreichbar sind
+           (unerreichbar) oder von denen aus kein Endzustand erreichbar ist (tot)
+
+    Beide Mengen werden mit einer ebenenweisen Breitensuche bestimmt, deren
+    Front parallel abgearbeitet wird: vorwärts vom Startzustand über die Zeilen
+    der Übergänge, rückwärts von den Endzuständen über einen Index der Vorgänger.
+    Besucht wird mit einem atomaren Markieren, so dass jeder Zustand genau einmal
+    in eine Front gelangt. Übergänge in tote Zustände entfallen; das ändert die
+    Sprache nicht, da von dort kein Wort mehr akzeptiert wird.
+    Der Startzustand bleibt immer erhalten. Die übrigen Zustände behalten ihre
+    Reihenfolge, ist nichts zu entfernen, bleibt der Automat unverändert.
+*/
+class Trimmer{
+
+  public:
+
+  ///	@brief Was beim letzten Aufruf entfernt wurde
+  struct Report{
+    unsigned unreachable; ///< Die Anzahl unerreichbarer Zustände
+    unsigned dead; ///< Die Anzahl erreichbarer, aber toter Zustände
+    std::size_t transitions; ///< Die Anzahl entfernter Übergänge
+    double seconds; ///< Die Dauer in Sekunden
+  };
+
+  ///@brief Der Konstruktor der Klasse
+  Trimmer(){
+    last.unreachable = last.dead = 0;
+    last.transitions = 0;
+    last.seconds = 0;
+  }
+
+  /** @brief Entfernt unerreichbare und tote Zustände
+      @param dfa Der Automat
+      @return die Anzahl der entfernten Zustände
+  */
+  unsigned operator()(DFA& dfa){
+    auto start = std::chrono::steady_clock::now();
+    unsigned n = dfa.state_count;
+    last.unreachable = last.dead = 0;
+    last.transitions = 0;
+
+    //Vorwärts vom Startzustand
+    std::unique_ptr<std::atomic<unsigned char>[]> reachable(new std::atomic<unsigned char>[n]);
+    std::unique_ptr<std::atomic<unsigned char>[]> alive(new std::atomic<unsigned char>[n]);
+    Parallel::parallel_for(0,n,[&](int i){
+      reachable[i].store(0,std::memory_order_relaxed);
+      alive[i].store(0,std::memory_order_relaxed);
+    });
+    front.assign(1,dfa.start_state);
+    reachable[dfa.start_state] = 1;
+    search(reachable.get(),[&dfa](unsigned s, std::vector<unsigned>& out, std::atomic<unsigned char>* mark){
+      for(unsigned j = dfa.transitions.begin(s);j!=dfa.transitions.end(s);++j) visit(dfa.transitions.target(j),out,mark);
+    });
+
+    //Rückwärts von den Endzuständen über den Index der Vorgänger
+    predecessors(dfa);
+    front.clear();
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it){
+      alive[*it] = 1;
+      front.push_back(*it);
+    }
+    search(alive.get(),[this](unsigned s, std::vector<unsigned>& out, std::atomic<unsigned char>* mark){
+      for(unsigned j = first[s];j!=first[s+1];++j) visit(sources[j],out,mark);
+    });
+    std::vector<unsigned>().swap(first);
+    std::vector<unsigned>().swap(sources);
+
+    //Neue Nummern, der Startzustand bleibt in jedem Fall erhalten
+    number.assign(n,Transitions::NONE);
+    std::vector<unsigned> live;
+    for(unsigned s = 0;s!=n;++s){
+      if(!reachable[s]) ++last.unreachable;
+      else if(!alive[s] && s != dfa.start_state) ++last.dead;
+      else{
+        number[s] = live.size();
+        live.push_back(s);
+      }
+    }
+    if(live.size() == n){
+      last.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return 0;
+    }
+
+    std::vector<Transitions::Arc> arcs;
+    arcs.reserve(dfa.transitions.edges());
+    for(auto it = live.begin();it!=live.end();++it){
+      for(unsigned j = dfa.transitions.begin(*it);j!=dfa.transitions.end(*it);++j){
+        unsigned t = number[dfa.transitions.target(j)];
+        if(t == Transitions::NONE) continue;
+        Transitions::Arc arc;
+        arc.source = number[*it];
+        arc.target = t;
+        arc.symbol = dfa.transitions.symbol(j);
+        arcs.push_back(arc);
+      }
+    }
+    last.transitions = dfa.transitions.edges() - arcs.size();
+    unsigned m = live.size();
+    dfa.transitions.assign(m,arcs);
+    dfa.signatures.assign(m);
+    for(auto it = arcs.begin();it!=arcs.end();++it) dfa.signatures.add(it->source,dfa.alphabet[it->symbol]);
+    std::unordered_set<unsigned> finals;
+    for(auto it = dfa.final_states.begin();it!=dfa.final_states.end();++it){
+      if(number[*it] == Transitions::NONE) continue;
+      finals.insert(number[*it]);
+      dfa.signatures.set_final(number[*it]);
+    }
+    dfa.final_states.swap(finals);
+    dfa.start_state = number[dfa.start_state];
+    dfa.state_count = m;
+    dfa.transition_count = arcs.size();
+    last.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return n - m;
+  }
+
+  ///@brief Was beim letzten Aufruf entfernt wurde
+  const Report& report() const{
+    return last;
+  }
+
+  ///@brief Die neue Nummer je Zustand vor dem letzten Aufruf, NONE für entfernte Zustände
+  const std::vector<unsigned>& mapping() const{
+    return number;
+  }
+
+  private:
+
+  //Markiert einen Zustand und nimmt ihn in die nächste Front auf, falls er neu ist
+  static void visit(unsigned t, std::vector<unsigned>& out, std::atomic<unsigned char>* mark){
+    if(!mark[t].load(std::memory_order_relaxed) && !mark[t].exchange(1)) out.push_back(t);
+  }
+
+  //Breitensuche ab front: jede Ebene wird in Blöcken parallel abgearbeitet,
+  //die Nachfolger jedes Blocks werden getrennt gesammelt und dann aneinandergehängt
+  template<class Expand>
+  void search(std::atomic<unsigned char>* mark, Expand expand){
+    const unsigned grain = 1024;
+    std::vector<std::vector<unsigned> > next;
+    while(!front.empty()){
+      unsigned blocks = (front.size() + grain - 1) / grain;
+      next.resize(blocks);
+      Parallel::parallel_for(0,blocks,[&](int b){
+        next[b].clear();
+        unsigned stop = std::min<std::size_t>((b + 1) * grain,front.size());
+        for(unsigned i = b * grain;i!=stop;++i) expand(front[i],next[b],mark);
+      },1);
+      front.clear();
+      for(unsigned b = 0;b!=blocks;++b) front.insert(front.end(),next[b].begin(),next[b].end());
+    }
+  }
+
+  //Baut den Index der Vorgänger (Counting Sort nach Zielzustand)
+  void predecessors(const DFA& dfa){
+    unsigned n = dfa.state_count;
+    first.assign(n+1,0);
+    for(unsigned s = 0;s!=n;++s){
+      for(unsigned j = dfa.transitions.begin(s);j!=dfa.transitions.end(s);++j) ++first[dfa.transitions.target(j)+1];
+    }
+    for(unsigned s = 0;s!=n;++s) first[s+1] += first[s];
+    sources.resize(first[n]);
+    std::vector<unsigned> fill(first.begin(),first.end()-1);
+    for(unsigned s = 0;s!=n;++s){
+      for(unsigned j = dfa.transitions.begin(s);j!=dfa.transitions.end(s);++j) sources[fill[dfa.transitions.target(j)]++] = s;
+    }
+  }
+
+  Report last; ///< Was beim letzten Aufruf entfernt wurde
+  std::vector<unsigned> number; ///< Die neue Nummer je Zustand, NONE für entfernte
+  std::vector<unsigned> front; ///< Die aktuelle Front der Breitensuche
+  std::vector<unsigned> first; ///< Der Anfang der Vorgänger je Zustand
+  std::vector<unsigned> sources; ///< Die Vorgänger, nach Zielzustand gruppiert
+
+};
+
+#endif
@@ -0,0 +1,310 @@
+////////////////////////////////////////////////////////////////////////////////
+// bench.cpp
+// Benchmarkprogramm für das Hopcroft Projekt
+// Compiler: MSVC++ 14, g++/clang++
+////////////////////////////////////////////////////////////////////////////////
+
+#include "../include/DFA.hpp"
+#include "../include/daciuk.hpp"
+#include "../include/tfsm.hpp"
+#include "../include/generators.hpp"
+#include <chrono>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+//Die Einstellungen aus der Kommandozeile
+struct Options{
+  Hopcroft::Engine engine = Hopcroft::MOORE;
+  std::string engine_name = "moore";
+  unsigned threads = 0;
+  double scale = 1;
+  unsigned repeats = 1;
+  std::uint32_t seed = 1;
+  std::string only;
+  std::string lexicon_file;
+};
+
+//Eine gemessene Phase: Wanduhrzeit und verarbeitete Menge
+struct Phase{
+  std::string name;
+  double seconds;
+  double amount;
+  std::string unit;
+};
+
+//Das Ergebnis eines Falls
+struct Result{
+  std::string name;
+  unsigned states = 0;
+  unsigned transitions = 0;
+  unsigned minimal_states = 0;
+  unsigned minimal_transitions = 0;
+  std::vector<Phase> phases;
+  long peak_rss_kb = 0;
+  std::string hopcroft;
+};
+
+void usage(){
+  std::cerr << "Usage:  'bench [options] > results.json'\n"
+            << "  -e engine  minimize with moore (default), worklist, revuz, auto or hash\n"
+            << "  -t n       number of threads (0 = all cores, default; 1 = serial)\n"
+            << "  -s x       scale all input sizes by x (default 1)\n"
+            << "  -r n       repeat every case n times and keep the fastest run of each phase\n"
+            << "  -S seed    seed of the generators (default 1)\n"
+            << "  -c name    run only this case (random_dfa, chain, fibonacci, lexicon, incremental, file)\n"
+            << "  -f file    also benchmark a lexicon file (one word per line)\n";
+  exit(1);
+}
+
+//Der bisher größte Speicherbedarf des Prozesses in KB
+long peak_rss_kb(){
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (GetProcessMemoryInfo(GetCurrentProcess(),&pmc,sizeof(pmc))) return (long)(pmc.PeakWorkingSetSize / 1024);
+  return 0;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF,&usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+//Die seit t vergangene Wanduhrzeit in Sekunden
+double since(std::chrono::steady_clock::time_point t){
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+//Übernimmt eine Phase; bei Wiederholungen zählt der schnellste Lauf
+void record(Result& r, const std::string& name, double seconds, double amount, const std::string& unit){
+  for (auto it = r.phases.begin(); it != r.phases.end(); ++it) {
+    if (it->name == name) {
+      if (seconds < it->seconds) it->seconds = seconds;
+      return;
+    }
+  }
+  r.phases.push_back(Phase{name,seconds,amount,unit});
+}
+
+//Minimiert und hält Verfeinerung und Aufbau getrennt fest
+void minimize(Result& r, DFA& dfa, const Options& options){
+  Hopcroft hopcroft(options.engine);
+  auto t = std::chrono::steady_clock::now();
+  hopcroft(dfa);
+  double total = since(t);
+  record(r,"minimize",total - hopcroft.stats().construct,r.states,"states/s");
+  record(r,"construct",hopcroft.stats().construct,r.states,"states/s");
+  record(r,"total_minimization",total,r.states,"states/s");
+  std::ostringstream o;
+  hopcroft.stats().write_json(o);
+  r.hopcroft = o.str();
+}
+
+//Ein Automat aus einem Generator: schreiben, einlesen, minimieren
+void automaton_case(Result& r, const std::string& text, const Options& options){
+  const char* filename = "bench_input.tfsm";
+  {
+    std::ofstream o(filename,std::ios::binary);
+    o << text;
+  }
+  for (unsigned k = 0; k != options.repeats; ++k) {
+    DFA dfa;
+    TfsmReader read;
+    auto t = std::chrono::steady_clock::now();
+    read(dfa,filename);
+    record(r,"parse",since(t),text.size() / 1e6,"MB/s");
+    r.states = dfa.number_of_states();
+    r.transitions = dfa.number_of_transitions();
+    minimize(r,dfa,options);
+    r.minimal_states = dfa.number_of_states();
+    r.minimal_transitions = dfa.number_of_transitions();
+  }
+  std::remove(filename);
+}
+
+//Ein Lexikon: Trie mit add_word aufbauen und minimieren
+void lexicon_case(Result& r, const std::vector<std::string>& words, const Options& options){
+  for (unsigned k = 0; k != options.repeats; ++k) {
+    DFA dfa;
+    auto t = std::chrono::steady_clock::now();
+    for (auto it = words.begin(); it != words.end(); ++it) dfa.add_word(*it);
+    record(r,"add_word",since(t),words.size(),"words/s");
+    r.states = dfa.number_of_states();
+    r.transitions = dfa.number_of_transitions();
+    minimize(r,dfa,options);
+    r.minimal_states = dfa.number_of_states();
+    r.minimal_transitions = dfa.number_of_transitions();
+  }
+}
+
+//Ein Lexikon inkrementell mit Daciuk aufbauen (immer minimal)
+void incremental_case(Result& r, const std::vector<std::string>& words, const Options& options){
+  for (unsigned k = 0; k != options.repeats; ++k) {
+    DFA dfa;
+    auto t = std::chrono::steady_clock::now();
+    {
+      Daciuk builder(dfa);
+      for (auto it = words.begin(); it != words.end(); ++it) builder.add(*it);
+      builder.compact();
+    }
+    record(r,"daciuk",since(t),words.size(),"words/s");
+    r.states = r.minimal_states = dfa.number_of_states();
+    r.transitions = r.minimal_transitions = dfa.number_of_transitions();
+  }
+}
+
+//Führt einen Fall aus und gibt das Ergebnis als JSON-Objekt zurück
+std::string run_case(const std::string& name, const Options& options){
+  Result r;
+  r.name = name;
+  Generator generator(options.seed);
+  unsigned scaled;
+  if (name == "random_dfa") {
+    scaled = std::max(1.0,100000 * options.scale);
+    std::ostringstream o;
+    generator.random_dfa(o,scaled,4,50);
+    automaton_case(r,o.str(),options);
+  }
+  else if (name == "chain") {
+    //Die schlechtesten Fälle sind kleiner, da MOORE und HASHING hier
+    //annähernd so viele Runden wie Zustände brauchen
+    scaled = std::max(2.0,2000 * options.scale);
+    std::ostringstream o;
+    generator.chain(o,scaled);
+    automaton_case(r,o.str(),options);
+  }
+  else if (name == "fibonacci") {
+    scaled = std::max(2.0,3000 * options.scale);
+    std::ostringstream o;
+    generator.fibonacci_cycle(o,scaled);
+    automaton_case(r,o.str(),options);
+  }
+  else if (name == "lexicon" || name == "incremental") {
+    scaled = std::max(1.0,200000 * options.scale);
+    std::vector<std::string> words;
+    generator.lexicon(words,scaled,26,3,14,60);
+    if (name == "lexicon") lexicon_case(r,words,options);
+    else incremental_case(r,words,options);
+  }
+  else if (name == "file") {
+    std::vector<std::string> words;
+    auto t = std::chrono::steady_clock::now();
+    std::ifstream in(options.lexicon_file.c_str());
+    std::size_t bytes = 0;
+    std::string word;
+    while (std::getline(in,word)) {
+      bytes += word.size() + 1;
+      if (!word.empty() && word[word.size()-1] == '\r') word.erase(word.size()-1);
+      words.push_back(word);
+    }
+    record(r,"parse",since(t),bytes / 1e6,"MB/s");
+    lexicon_case(r,words,options);
+  }
+  r.peak_rss_kb = peak_rss_kb();
+
+  std::ostringstream o;
+  o << "    {\"name\": \"" << r.name << "\", \"states\": " << r.states << ", \"transitions\": " << r.transitions
+    << ", \"minimal_states\": " << r.minimal_states << ", \"minimal_transitions\": " << r.minimal_transitions
+    << ", \"peak_rss_kb\": " << r.peak_rss_kb << ",\n     \"phases\": [";
+  for (auto it = r.phases.begin(); it != r.phases.end(); ++it) {
+    o << (it == r.phases.begin() ? "\n" : ",\n")
+      << "       {\"name\": \"" << it->name << "\", \"seconds\": " << it->seconds
+      << ", \"throughput\": " << (it->seconds > 0 ? it->amount / it->seconds : 0)
+      << ", \"unit\": \"" << it->unit << "\"}";
+  }
+  o << "]";
+  if (!r.hopcroft.empty()) o << ",\n     \"hopcroft\": " << r.hopcroft;
+  o << "}";
+  return o.str();
+}
+
+//Führt einen Fall in einem eigenen Prozess aus, damit der Speicherbedarf je Fall gemessen wird
+std::string run_isolated(const std::string& name, const Options& options){
+#ifndef _WIN32
+  int fds[2];
+  if (pipe(fds) == 0) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(fds[0]);
+      std::string s = run_case(name,options);
+      for (std::size_t done = 0; done < s.size();) {
+        ssize_t n = write(fds[1],s.data() + done,s.size() - done);
+        if (n <= 0) break;
+        done += n;
+      }
+      close(fds[1]);
+      _exit(0);
+    }
+    close(fds[1]);
+    std::string s;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0],buffer,sizeof(buffer))) > 0) s.append(buffer,n);
+    close(fds[0]);
+    if (pid > 0) {
+      waitpid(pid,nullptr,0);
+      return s;
+    }
+  }
+#endif
+  return run_case(name,options);
+}
+
+int main(int argc, char* argv[]){
+  //Auswertung der Optionen
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "-e" && i+1 < argc) {
+      options.engine_name = argv[++i];
+      if (options.engine_name == "moore") options.engine = Hopcroft::MOORE;
+      else if (options.engine_name == "worklist") options.engine = Hopcroft::WORKLIST;
+      else if (options.engine_name == "revuz") options.engine = Hopcroft::REVUZ;
+      else if (options.engine_name == "auto") options.engine = Hopcroft::AUTOMATIC;
+      else if (options.engine_name == "hash") options.engine = Hopcroft::HASHING;
+      else usage();
+    }
+    else if (arg == "-t" && i+1 < argc) options.threads = atoi(argv[++i]);
+    else if (arg == "-s" && i+1 < argc) options.scale = atof(argv[++i]);
+    else if (arg == "-r" && i+1 < argc) options.repeats = std::max(1,atoi(argv[++i]));
+    else if (arg == "-S" && i+1 < argc) options.seed = strtoul(argv[++i],nullptr,10);
+    else if (arg == "-c" && i+1 < argc) options.only = argv[++i];
+    else if (arg == "-f" && i+1 < argc) options.lexicon_file = argv[++i];
+    else usage();
+  }
+  Parallel::set_threads(options.threads);
+  if (Parallel::threads() == 1) Parallel::set_backend(Parallel::SERIAL);
+
+  std::vector<std::string> cases = {"random_dfa","chain","fibonacci","lexicon","incremental"};
+  if (!options.lexicon_file.empty()) cases.push_back("file");
+  if (!options.only.empty()) {
+    if (std::find(cases.begin(),cases.end(),options.only) == cases.end()) usage();
+    cases.assign(1,options.only);
+  }
+
+  //Ausgabe als JSON auf stdout, Fortschritt auf stderr
+  std::cout << "{\"version\": 1, \"engine\": \"" << options.engine_name << "\", \"threads\": " << Parallel::threads()
+            << ", \"scale\": " << options.scale << ", \"repeats\": " << options.repeats << ", \"seed\": " << options.seed
+            << ",\n  \"cases\": [\n";
+  for (std::size_t i = 0; i != cases.size(); ++i) {
+    std::cerr << cases[i] << "...\n";
+    std::cout << run_isolated(cases[i],options) << (i + 1 != cases.size() ? ",\n" : "\n");
+    std::cout.flush();
+  }
+  std::cout << "  ]\n}\n";
+}
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+// codegen_test.cpp
+// Testprogramm für das Hopcroft Projekt
+// Vergleicht einen mit DFA::generate erzeugten Erkenner mit dem Automaten
+// Compiler: MSVC++ 14, g++/clang++
+////////////////////////////////////////////////////////////////////////////////
+
+#include "../include/DFA.hpp"
+#include "../include/recognizer.hpp"
+#include <vector>
+#include <string>
+
+//Der erzeugte Erkenner, z.B. mit "test -g bin/recognizer.hpp < lexicon" geschrieben
+#ifndef GENERATED
+#define GENERATED "../bin/recognizer.hpp"
+#endif
+#include GENERATED
+
+//Vergleicht beide Erkenner für ein Wort, gibt Abweichungen aus
+unsigned check(const Recognizer& automaton, const std::string& word){
+  bool expected = automaton.accepts(word);
+  if(recognize(word) == expected && recognize(word.data(),word.size()) == expected) return 0;
+  std::cerr << "Mismatch: '" << word << "' is " << (expected ? "accepted" : "rejected") << " by the automaton\n";
+  return 1;
+}
+
+int main(int argc, char* argv[]){
+  if(argc != 2){
+    std::cerr << "Usage: 'codegen_test [lexicon-file]', the recognizer must have been generated from the same lexicon\n";
+    return 1;
+  }
+  std::ifstream in(argv[1]);
+  if(!in){
+    std::cerr << "Error: cannot open " << argv[1] << "\n";
+    return 1;
+  }
+
+  //Derselbe Aufbau wie im Testprogramm: Trie, dann Minimierung
+  DFA dfa;
+  std::vector<std::string> words;
+  std::string word;
+  while(std::getline(in,word)){
+    if(!word.empty() && word[word.size()-1] == '\r') word.erase(word.size()-1);
+    dfa.add_word(word);
+    words.push_back(word);
+  }
+  Hopcroft minimize;
+  minimize(dfa);
+  Recognizer automaton(dfa);
+
+  //Alle Wörter, dazu Präfixe, Verlängerungen und veränderte Wörter, die meist abgelehnt werden
+  unsigned mismatches = 0;
+  std::size_t checked = 0;
+  mismatches += check(automaton,"");
+  for(auto it = words.begin();it!=words.end();++it){
+    const std::string& w = *it;
+    mismatches += check(automaton,w);
+    mismatches += check(automaton,w + "s");
+    mismatches += check(automaton,w + "\xe4");
+    checked += 3;
+    if(!w.empty()){
+      mismatches += check(automaton,w.substr(0,w.size()-1));
+      mismatches += check(automaton,w.substr(1));
+      std::string changed(w);
+      changed[changed.size()/2] ^= 1;
+      mismatches += check(automaton,changed);
+      checked += 3;
+    }
+    if(mismatches > 20) break;
+  }
+
+  std::cout << checked << " words checked, " << mismatches << " mismatches.\n";
+  return mismatches ? 1 : 0;
+}
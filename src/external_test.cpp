@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+// external_test.cpp
+// Testprogramm für das Hopcroft Projekt
+// Vergleicht die externe Minimierung (-x, mit und ohne -k) mit Hopcroft im Speicher
+// und prüft Hopcroft::partition() an den Übergängen der Eingabe
+// Compiler: MSVC++ 14, g++/clang++
+////////////////////////////////////////////////////////////////////////////////
+
+#include "../include/DFA.hpp"
+#include "../include/external.hpp"
+#include "../include/equivalence.hpp"
+#include "../include/binary.hpp"
+#include "../include/generators.hpp"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+
+//Die Dateien des Tests
+const char* input_file = "external_test.tfsm";
+const char* output_file = "external_test_minimal.tfsm";
+const char* binary_file = "external_test_minimal.bin";
+
+//Prüft, ob partition() ein Homomorphismus der Eingabe auf den minimalen Automaten ist:
+//Start auf Start, Endzustände auf Endzustände und jeder Übergang (s,c,t) auf (partition[s],c,partition[t]).
+//Getrimmte Zustände bilden auf NONE ab, Übergänge in sie fehlen im minimalen Automaten
+unsigned check_partition(unsigned number, bool trim, const std::vector<unsigned>& partition, const DFA& minimal){
+  const char* mode = trim ? "" : " (-k)";
+  MappedDFA mapped;
+  if(!BinaryFormat::save(minimal,binary_file) || !mapped.open(binary_file)){
+    std::cerr << "Mismatch: automaton " << number << mode << " could not be saved for the partition check\n";
+    return 1;
+  }
+  std::ifstream in(input_file);
+  std::vector<bool> final;
+  std::string line;
+  unsigned start = Transitions::NONE;
+  unsigned errors = 0;
+  while(std::getline(in,line)){
+    std::istringstream fields(line);
+    unsigned source, target;
+    char c;
+    fields >> source;
+    if(source >= partition.size()){
+      errors++;
+      continue;
+    }
+    if(!(fields >> target >> c)){
+      //Endzustand
+      if(final.size() <= source) final.resize(source+1,false);
+      final[source] = true;
+      continue;
+    }
+    if(start == Transitions::NONE) start = source;
+    if(target >= partition.size()){
+      errors++;
+      continue;
+    }
+    unsigned p = partition[source], q = partition[target];
+    if(p == Transitions::NONE){
+      if(!trim) errors++;
+      continue;
+    }
+    if(mapped.find(p,c) != q) errors++;
+  }
+  for(unsigned s = 0;s!=partition.size();++s){
+    if(partition[s] == Transitions::NONE){
+      if(!trim) errors++;
+    }
+    else if(partition[s] >= mapped.state_count() || mapped.is_final(partition[s]) != (s < final.size() && final[s])) errors++;
+  }
+  if(start != Transitions::NONE && partition[start] != mapped.start_state()) errors++;
+  if(errors) std::cerr << "Mismatch: automaton " << number << mode << ": partition() is wrong for " << errors << " states and transitions\n";
+  return errors ? 1 : 0;
+}
+
+//Minimiert die Eingabedatei extern und im Speicher, gibt Abweichungen aus
+unsigned check(unsigned number, bool trim){
+  const char* mode = trim ? "" : " (-k)";
+  ExternalMinimizer external;
+  external.set_trim(trim);
+  if(!external(input_file,output_file,ExternalMinimizer::TFSM)){
+    std::cerr << "Mismatch: automaton " << number << mode << " could not be minimized externally\n";
+    return 1;
+  }
+
+  DFA expected;
+  TfsmReader read;
+  read(expected,input_file);
+  Hopcroft minimize;
+  minimize.set_trim(trim);
+  minimize(expected);
+  unsigned mismatches = check_partition(number,trim,minimize.partition(),expected);
+  DFA result;
+  read(result,output_file);
+
+  if(external.minimal_states() != expected.number_of_states() || external.minimal_transitions() != expected.number_of_transitions()){
+    std::cerr << "Mismatch: automaton " << number << mode << " has " << external.minimal_states() << " states and "
+              << external.minimal_transitions() << " transitions externally, " << expected.number_of_states() << " and "
+              << expected.number_of_transitions() << " in memory\n";
+    mismatches++;
+  }
+  if(trim && (external.unreachable_states() != minimize.trimmed().unreachable || external.dead_states() != minimize.trimmed().dead)){
+    std::cerr << "Mismatch: automaton " << number << " had " << external.unreachable_states() << " unreachable and "
+              << external.dead_states() << " dead states removed externally, " << minimize.trimmed().unreachable << " and "
+              << minimize.trimmed().dead << " in memory\n";
+    mismatches++;
+  }
+  Equivalence equivalent;
+  if(!equivalent(result,expected)){
+    std::cerr << "Mismatch: automaton " << number << mode << ": '" << equivalent.counterexample() << "' is "
+              << (equivalent.accepted_by_first() ? "accepted" : "rejected") << " by the external result only\n";
+    mismatches++;
+  }
+  return mismatches;
+}
+
+int main(int argc, char* argv[]){
+  if(argc > 3){
+    std::cerr << "Usage: 'external_test [count [seed]]', compares count (default 300) random automata\n";
+    return 1;
+  }
+  unsigned count = argc > 1 ? std::atoi(argv[1]) : 300;
+  Generator generator(argc > 2 ? std::atoi(argv[2]) : 1);
+
+  //Unvollständige Automaten mit wenigen Endzuständen haben unerreichbare und tote Zustände,
+  //bei 0% Endzuständen ist die Sprache leer
+  unsigned mismatches = 0;
+  unsigned checked = 0;
+  for(unsigned i = 0;i!=count && mismatches <= 20;++i){
+    {
+      std::ofstream o(input_file,std::ios::binary);
+      generator.random_dfa(o,1 + i * 37 % 400,1 + i % 5,i % 7 * 5,i % 3 == 0 ? 100 : 30 + i % 50);
+    }
+    mismatches += check(i,true);
+    mismatches += check(i,false);
+    checked++;
+  }
+  std::remove(input_file);
+  std::remove(output_file);
+  std::remove(binary_file);
+
+  std::cout << checked << " automata checked, " << mismatches << " mismatches.\n";
+  return mismatches ? 1 : 0;
+}
@@ -7,58 +7,482 @@
 
 #include <ctime>
 #include "../include/DFA.hpp"
+#include "../include/daciuk.hpp"
+#include "../include/tfsm.hpp"
+#include "../include/binary.hpp"
+#include "../include/recognizer.hpp"
+#include "../include/perfect_hash.hpp"
+#include "../include/external.hpp"
+#include "../include/sharded.hpp"
+#include "../include/batch.hpp"
+#include "../include/equivalence.hpp"
+#include "../include/subset.hpp"
+#include "../include/product.hpp"
+#include <chrono>
 
 double start;
 double end;
 
-int main(int argc, char* argv[]){
-  if (argc > 2) {
-    std::cerr << "Usage:  'test [tfsm-file]' or 'test < [lexicon-file]'";
+void usage(){
+  std::cerr << "Usage:  'test [-e engine] [tfsm-file]' or 'test [-i|-m|-e engine] < [lexicon-file]'\n"
+            << "  -i         build the lexicon incrementally (always minimal)\n"
+            << "  -m         build the lexicon in parallel shards and merge them\n"
+            << "  -e engine  minimize with moore (default), worklist, revuz, auto or hash\n"
+            << "  -c         merge symbols with identical behavior into classes before minimizing\n"
+            << "  -n         read the tfsm-file as a nondeterministic automaton and determinize it first\n"
+            << "  -L order   renumber the minimal states for locality: bfs, dfs or freq (lexicon words as query sample)\n"
+            << "  -k         keep unreachable and dead states (no trimming before minimizing, also with -x)\n"
+            << "  -r n       minimize n copies of the tfsm-file as one batch and compare with single calls\n"
+            << "  -j file    write statistics of the minimization as JSON\n"
+            << "  -t n       number of threads (0 = all cores, 1 = serial)\n"
+            << "  -s file    save the minimal automaton in binary format\n"
+            << "  -b file    map a binary automaton, verify it and report its size\n"
+            << "  -l         benchmark lookups of all lexicon words on the minimal automaton\n"
+            << "             (with -b on the mapped automaton, lexicon from stdin)\n"
+            << "  -p         check perfect hashing (word <-> index) of all lexicon words\n"
+            << "  -x MB      minimize the tfsm-file out of core within MB megabytes of memory,\n"
+            << "             write the result with -o file (tfsm) and/or -s file (binary)\n"
+            << "  -o file    write the minimal automaton of -x in tfsm format\n"
+            << "  -d dir     directory for the temporary files of -x (default: current directory)\n"
+            << "  -u file    apply updates to the minimal automaton, one per line: +word adds, -word removes\n"
+            << "  -g file    write a C++ recognizer of the minimal automaton (switch per state)\n"
+            << "  -G file    write a C++ recognizer of the minimal automaton (constexpr tables)\n"
+            << "  -P op file combine the minimal automaton with the tfsm-file (and, or, minus) and minimize the product\n"
+            << "  -v file    check that the minimal automaton accepts the same language as the tfsm-file\n";
+  exit(1);
+}
+
+//Misst Einzel- und Stapelabfragen über alle Wörter des Lexikons
+void benchmark_lookups(const DFA& dfa, const std::vector<std::string>& words){
+  Recognizer recognizer(dfa);
+  const int rounds = 10;
+  std::size_t accepted = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (std::size_t i = 0; i < words.size(); ++i) accepted += recognizer.accepts(words[i]);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  std::unique_ptr<bool[]> results(new bool[words.size()]);
+  for (int r = 0; r < rounds; ++r) recognizer.accepts(words.data(),words.size(),results.get());
+  auto t2 = std::chrono::steady_clock::now();
+  double lookups = double(rounds) * words.size();
+  std::cout << "Lookups: " << accepted / rounds << " of " << words.size() << " accepted, "
+            << lookups / std::chrono::duration<double>(t1-t0).count() << "/s single, "
+            << lookups / std::chrono::duration<double>(t2-t1).count() << "/s batched.\n";
+}
+
+//Misst Abfragen aller Wörter auf dem eingeblendeten Automaten und vergleicht sie mit dem
+//über BinaryFormat::load geladenen Automaten
+void benchmark_mapped(const MappedDFA& mapped, const char* filename, const std::vector<std::string>& words){
+  DFA loaded;
+  auto t0 = std::chrono::steady_clock::now();
+  if (!BinaryFormat::load(loaded,filename)) exit(1);
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Loaded in " << std::chrono::duration<double>(t1-t0).count() << "s: " << loaded << std::endl;
+  if (loaded.number_of_states() != mapped.state_count() || loaded.number_of_transitions() != mapped.transition_count())
+    std::cerr << "Error: the loaded automaton differs in size from the mapped one.\n";
+  if (words.empty()) return;
+  const int rounds = 10;
+  std::size_t accepted = 0;
+  t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (std::size_t i = 0; i < words.size(); ++i) accepted += mapped.accepts(words[i]);
+  }
+  t1 = std::chrono::steady_clock::now();
+  Recognizer recognizer(loaded);
+  std::size_t mismatches = 0;
+  for (std::size_t i = 0; i < words.size(); ++i) mismatches += mapped.accepts(words[i]) != recognizer.accepts(words[i]);
+  std::cout << "Mapped lookups: " << accepted / rounds << " of " << words.size() << " accepted, "
+            << double(rounds) * words.size() / std::chrono::duration<double>(t1-t0).count() << "/s, "
+            << mismatches << " mismatches with the loaded automaton.\n";
+}
+
+//Prüft das perfekte Hashing: jedes Wort erhält einen eigenen Index aus [0,n) und umgekehrt
+void check_perfect_hash(const DFA& dfa, const std::vector<std::string>& words){
+  PerfectHash hash(dfa);
+  if (!hash.valid()) return;
+  std::vector<std::uint64_t> indices(words.size());
+  auto t0 = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < words.size(); ++i) indices[i] = hash.index(words[i]);
+  auto t1 = std::chrono::steady_clock::now();
+  std::size_t errors = 0;
+  std::vector<bool> seen(hash.size(),false);
+  std::string word;
+  for (std::size_t i = 0; i < words.size(); ++i) {
+    if (indices[i] >= hash.size() || !hash.word(indices[i],word) || word != words[i]) ++errors;
+    else seen[indices[i]] = true;
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  std::size_t covered = std::count(seen.begin(),seen.end(),true);
+  std::cout << "Perfect hash: " << hash.size() << " words, " << covered << " indices covered, " << errors << " errors, "
+            << words.size() / std::chrono::duration<double>(t1-t0).count() << " word->index/s, "
+            << words.size() / std::chrono::duration<double>(t2-t1).count() << " index->word/s, "
+            << hash.memory() << " bytes.\n";
+}
+
+//Vergleicht die Sprache des Automaten mit der eines Automaten aus einer tfsm-Datei
+void check_equivalence(const DFA& dfa, const char* filename){
+  DFA other;
+  TfsmReader read;
+  if (!read(other,filename)) {
+    std::cerr << "Error: cannot open " << filename << "\n";
     exit(1);
   }
-  else if (argc == 2){
-    std::ifstream dfa_in(argv[1]);
-    
-    DFA* dfa = new DFA(dfa_in);
-    
-    std::cout << *dfa;
-    std::cout << std::endl;
-    dfa->draw("test.dot");
-    
-    Hopcroft* minimize = new Hopcroft();
+  Equivalence equal;
+  if (equal(dfa,other))
+    std::cout << "Equivalent to " << filename << " (" << equal.pairs_visited() << " state pairs in " << equal.duration() << "s).\n";
+  else
+    std::cout << "Not equivalent to " << filename << ": '" << equal.counterexample() << "' is accepted only by "
+              << (equal.accepted_by_first() ? "the minimal automaton" : filename) << ".\n";
+}
+
+//Nummeriert die Zustände eines ohne Hopcroft minimierten Automaten neu
+void relayout(DFA& dfa, Renumbering::Order order, const std::vector<std::string>& words){
+  Renumbering renumber(order);
+  if (!words.empty()) renumber.set_sample(words);
+  renumber(dfa);
+  std::cout << "Renumbered the minimal states in " << renumber.duration() << "s.\n";
+}
+
+//Ersetzt den Automaten durch das minimierte Produkt mit einem Automaten aus einer tfsm-Datei
+void combine(DFA& dfa, Product::Operation operation, const char* filename, Hopcroft::Engine engine){
+  DFA other;
+  TfsmReader read;
+  if (!read(other,filename)) {
+    std::cerr << "Error: cannot open " << filename << "\n";
+    exit(1);
+  }
+  auto t0 = std::chrono::steady_clock::now();
+  DFA result;
+  Product product(dfa,other,operation);
+  product.materialize(result);
+  auto t1 = std::chrono::steady_clock::now();
+  Hopcroft minimize(engine);
+  minimize(result);
+  auto t2 = std::chrono::steady_clock::now();
+  std::cout << "Built " << product.states() << " of " << product.bound() << " state pairs in "
+            << std::chrono::duration<double>(t1-t0).count() << "s, minimized in " << std::chrono::duration<double>(t2-t1).count() << "s.\n";
+  dfa = result;
+  std::cout << dfa;
+  std::cout << std::endl;
+}
+
+//Fügt Wörter in den minimalen Automaten ein bzw. entfernt sie, ohne ihn neu aufzubauen
+void apply_updates(DFA& dfa, const char* filename){
+  std::ifstream in(filename);
+  if (!in) {
+    std::cerr << "Error: cannot open " << filename << "\n";
+    exit(1);
+  }
+  Daciuk update(dfa);
+  std::size_t added = 0, removed = 0, lines = 0;
+  std::string line;
+  auto t0 = std::chrono::steady_clock::now();
+  while (std::getline(in,line)) {
+    if (!line.empty() && line[line.size()-1] == '\r') line.erase(line.size()-1);
+    if (line.empty()) continue;
+    ++lines;
+    if (line[0] == '+') {
+      update.add(line.substr(1));
+      ++added;
+    }
+    else if (line[0] == '-') removed += update.remove(line.substr(1));
+    else std::cerr << "Warning: ignoring update '" << line << "'\n";
+  }
+  update.compact();
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Applied " << lines << " updates (" << added << " added, " << removed << " removed) in "
+            << std::chrono::duration<double>(t1-t0).count() << "s.\n";
+  std::cout << dfa;
+  std::cout << std::endl;
+}
+
+//Vergleicht die Minimierung vieler Kopien mit je einem Hopcroft gegen BatchMinimizer
+void benchmark_batch(const DFA& dfa, unsigned copies, Hopcroft::Engine engine, bool classes, bool trim){
+  std::vector<DFA> single(copies,dfa);
+  std::vector<DFA> batch(copies,dfa);
+  auto t0 = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < copies; ++i) {
+    Hopcroft minimize(engine);
+    minimize.set_symbol_classes(classes);
+    minimize.set_trim(trim);
+    minimize(single[i]);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  BatchMinimizer minimize(engine);
+  minimize.set_symbol_classes(classes);
+  minimize.set_trim(trim);
+  minimize(batch);
+  std::cout << "Batch of " << copies << " (" << minimize.small_jobs() << " small, " << minimize.large_jobs() << " large): "
+            << copies / std::chrono::duration<double>(t1-t0).count() << " automata/s single, "
+            << copies / minimize.duration() << " automata/s batched.\n";
+  std::cout << batch[0];
+  std::cout << std::endl;
+}
+
+///@brief Die Aufgaben nach der Minimierung, in allen Modi gleich
+struct Tasks{
+  Tasks(){
+    update_file = nullptr;
+    product_file = nullptr;
+    operation = Product::INTERSECTION;
+    code_file = nullptr;
+    code_style = DFA::SWITCH;
+    reference_file = nullptr;
+    save_file = nullptr;
+    lookups = false;
+    hashing = false;
+  }
+  char* update_file; ///< Änderungen für Daciuk (-u)
+  char* product_file; ///< Der zweite Operand des Produkts (-P)
+  Product::Operation operation; ///< Die Verknüpfung des Produkts
+  char* code_file; ///< Die Ausgabe des Codegenerators (-g, -G)
+  DFA::CodeStyle code_style; ///< Die Form des erzeugten Codes
+  char* reference_file; ///< Der Automat für den Sprachvergleich (-v)
+  char* save_file; ///< Die Ausgabe im Binärformat (-s)
+  bool lookups; ///< Abfragen aller Wörter messen (-l)
+  bool hashing; ///< Perfektes Hashing prüfen (-p)
+};
+
+//Minimiert einen eingelesenen Automaten mit Hopcroft und berichtet über die einzelnen Schritte
+void run_hopcroft(DFA& dfa, Hopcroft::Engine engine, bool classes, bool trim, Renumbering::Order layout,
+                  const std::vector<std::string>& words, const char* stats_file){
+  Hopcroft minimize(engine);
+  minimize.set_symbol_classes(classes);
+  minimize.set_trim(trim);
+  minimize.set_layout(layout,words.empty() ? nullptr : &words);
+  
+  start = clock();
+  minimize(dfa);
+  end = clock();
+  std::cout << "Minimized in " << (end-start) / CLOCKS_PER_SEC << "s.\n";
+  if (trim && minimize.trimmed().unreachable + minimize.trimmed().dead)
+    std::cout << "Trimmed " << minimize.trimmed().unreachable << " unreachable and " << minimize.trimmed().dead << " dead states ("
+              << minimize.trimmed().transitions << " transitions) in " << minimize.trimmed().seconds << "s.\n";
+  if (minimize.symbol_classes()) std::cout << "Merged the alphabet into " << minimize.symbol_classes() << " symbol classes.\n";
+  if (layout != Renumbering::KEEP) std::cout << "Renumbered the minimal states in " << minimize.layout().duration() << "s.\n";
+  if (stats_file) {
+    std::ofstream o(stats_file);
+    minimize.stats().write_json(o);
+    o << "\n";
+  }
+}
+
+//Gibt den minimalen Automaten aus und erledigt die angeforderten Aufgaben, in allen Modi gleich
+void finish(DFA& dfa, const Tasks& tasks, Hopcroft::Engine engine, const std::vector<std::string>& words){
+  std::cout << dfa;
+  std::cout << std::endl;
+  dfa.draw("test_minimal.dot");
+  if (tasks.update_file) apply_updates(dfa,tasks.update_file);
+  if (tasks.product_file) combine(dfa,tasks.operation,tasks.product_file,engine);
+  if (tasks.code_file) dfa.generate(tasks.code_file,"recognize",tasks.code_style);
+  if (tasks.reference_file) check_equivalence(dfa,tasks.reference_file);
+  if (tasks.save_file && !BinaryFormat::save(dfa,tasks.save_file)) std::cerr << "Error: cannot write " << tasks.save_file << "\n";
+  if (tasks.lookups) benchmark_lookups(dfa,words);
+  if (tasks.hashing) check_perfect_hash(dfa,words);
+}
+
+int main(int argc, char* argv[]){
+  //Auswertung der Optionen
+  bool incremental = false;
+  bool sharded = false;
+  bool nondeterministic = false;
+  Hopcroft::Engine engine = Hopcroft::MOORE;
+  char* tfsm_file = nullptr;
+  char* binary_file = nullptr;
+  bool classes = false;
+  bool trim = true;
+  Renumbering::Order layout = Renumbering::KEEP;
+  unsigned copies = 0;
+  char* stats_file = nullptr;
+  std::size_t budget = 0;
+  char* output_file = nullptr;
+  char* temp_directory = nullptr;
+  Tasks tasks;
+  std::vector<std::string> words;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if (arg == "-i") incremental = true;
+    else if (arg == "-m") sharded = true;
+    else if (arg == "-n") nondeterministic = true;
+    else if (arg == "-e" && i+1 < argc) {
+      std::string name(argv[++i]);
+      if (name == "moore") engine = Hopcroft::MOORE;
+      else if (name == "worklist") engine = Hopcroft::WORKLIST;
+      else if (name == "revuz") engine = Hopcroft::REVUZ;
+      else if (name == "auto") engine = Hopcroft::AUTOMATIC;
+      else if (name == "hash") engine = Hopcroft::HASHING;
+      else usage();
+    }
+    else if (arg == "-t" && i+1 < argc) {
+      unsigned threads = atoi(argv[++i]);
+      Parallel::set_threads(threads);
+      if (threads == 1) Parallel::set_backend(Parallel::SERIAL);
+    }
+    else if (arg == "-s" && i+1 < argc) tasks.save_file = argv[++i];
+    else if (arg == "-b" && i+1 < argc) binary_file = argv[++i];
+    else if (arg == "-l") tasks.lookups = true;
+    else if (arg == "-p") tasks.hashing = true;
+    else if (arg == "-c") classes = true;
+    else if (arg == "-k") trim = false;
+    else if (arg == "-L" && i+1 < argc) {
+      std::string name(argv[++i]);
+      if (name == "bfs") layout = Renumbering::BFS;
+      else if (name == "dfs") layout = Renumbering::DFS;
+      else if (name == "freq") layout = Renumbering::FREQUENCY;
+      else usage();
+    }
+    else if (arg == "-r" && i+1 < argc) copies = atoi(argv[++i]);
+    else if (arg == "-j" && i+1 < argc) stats_file = argv[++i];
+    else if (arg == "-x" && i+1 < argc) budget = std::size_t(atoi(argv[++i])) << 20;
+    else if (arg == "-o" && i+1 < argc) output_file = argv[++i];
+    else if (arg == "-d" && i+1 < argc) temp_directory = argv[++i];
+    else if (arg == "-u" && i+1 < argc) tasks.update_file = argv[++i];
+    else if (arg == "-g" && i+1 < argc) tasks.code_file = argv[++i];
+    else if (arg == "-v" && i+1 < argc) tasks.reference_file = argv[++i];
+    else if (arg == "-P" && i+2 < argc) {
+      std::string name(argv[++i]);
+      if (name == "and") tasks.operation = Product::INTERSECTION;
+      else if (name == "or") tasks.operation = Product::UNION;
+      else if (name == "minus") tasks.operation = Product::DIFFERENCE;
+      else usage();
+      tasks.product_file = argv[++i];
+    }
+    else if (arg == "-G" && i+1 < argc) {
+      tasks.code_file = argv[++i];
+      tasks.code_style = DFA::TABLES;
+    }
+    else if (arg[0] != '-' && !tfsm_file) tfsm_file = argv[i];
+    else usage();
+  }
+  if ((incremental && tfsm_file) || (binary_file && (incremental || tfsm_file))) usage();
+  if (sharded && (incremental || tfsm_file || binary_file)) usage();
+  if (nondeterministic && (!tfsm_file || budget)) usage();
+  if ((budget && (!tfsm_file || (!output_file && !tasks.save_file))) || ((output_file || temp_directory) && !budget)) usage();
+  if ((tasks.code_file || tasks.reference_file || tasks.product_file) && (budget || binary_file)) usage();
+  //Abfragen und perfektes Hashing brauchen die Wörter eines Lexikons
+  if (tasks.lookups && tfsm_file) usage();
+  if (tasks.hashing && (tfsm_file || binary_file)) usage();
+  //Die Neunummerierung gibt es nur im Speicher, die Stichprobe für freq sind die Wörter eines Lexikons
+  if ((layout != Renumbering::KEEP && (budget || binary_file)) || (layout == Renumbering::FREQUENCY && tfsm_file)) usage();
+  if (tasks.update_file && (budget || binary_file)) usage();
+  //Nur die Minimierung einer tfsm-Datei bzw. eines Lexikons mit Hopcroft kennt diese Optionen
+  if (copies && (!tfsm_file || budget)) usage();
+  if (stats_file && (budget || binary_file || incremental || sharded)) usage();
+  if (classes && (budget || binary_file || incremental || sharded)) usage();
+  if (!trim && (binary_file || incremental || sharded)) usage();
+  
+  if (binary_file){
+    //Einblenden ohne Deserialisierung
+    MappedDFA mapped;
+    start = clock();
+    if (!mapped.open(binary_file)) exit(1);
+    end = clock();
+    std::cout << "Mapped and verified in " << (end-start) / CLOCKS_PER_SEC << "s.\n";
+    std::cout << "acceptor, " << mapped.state_count() << " states, "
+              << mapped.transition_count() << " transitions\n";
+    std::string word;
+    while (tasks.lookups && std::getline(std::cin,word)) {
+      if (!word.empty() && word[word.size()-1] == '\r') word.erase(word.size()-1);
+      words.push_back(word);
+    }
+    benchmark_mapped(mapped,binary_file,words);
+    return 0;
+  }
+  else if (budget){
+    //Minimierung außerhalb des Hauptspeichers, der Automat wird nie vollständig geladen
+    ExternalMinimizer minimize(budget,temp_directory ? temp_directory : ".");
+    minimize.set_trim(trim);
+    if (!minimize(tfsm_file,output_file ? output_file : "",tasks.save_file ? tasks.save_file : "")) exit(1);
+    std::cout << "Minimized out of core in " << minimize.duration() << "s, "
+              << minimize.rounds() << " rounds, " << minimize.io_bytes() / (1 << 20) << " MB written to temporary files.\n";
+    if (trim && minimize.unreachable_states() + minimize.dead_states())
+      std::cout << "Trimmed " << minimize.unreachable_states() << " unreachable and " << minimize.dead_states() << " dead states ("
+                << minimize.pruned_transitions() << " transitions) in " << minimize.trim_rounds() << " rounds.\n";
+    std::cout << "acceptor, " << minimize.states() << " states, " << minimize.transitions() << " transitions\n";
+    std::cout << "minimal, " << minimize.minimal_states() << " states, " << minimize.minimal_transitions() << " transitions\n";
+    return 0;
+  }
+  else if (incremental){
+    //Inkrementeller Aufbau: der Automat ist nach jedem Wort minimal,
+    //es wird also nie ein vollständiger Trie aufgebaut
+    DFA* dfa = new DFA;
+    Daciuk builder(*dfa);
     
+    std::string word;
     start = clock();
-    (*minimize)(*dfa);
+    while (std::getline(std::cin,word)) {
+      if (!word.empty() && word[word.size()-1] == '\r') word.erase(word.size()-1);
+      builder.add(word);
+      if (tasks.lookups || tasks.hashing || layout == Renumbering::FREQUENCY) words.push_back(word);
+    }
+    builder.compact();
     end = clock();
-    std::cout << "Minimized in " << (end-start) / CLOCKS_PER_SEC << "s.\n";
+    std::cout << "Built incrementally in " << (end-start) / CLOCKS_PER_SEC << "s.\n";
+    if (layout != Renumbering::KEEP) relayout(*dfa,layout,words);
+    finish(*dfa,tasks,engine,words);
+  }
+  else if (sharded){
+    //Paralleler Aufbau: minimale Teilautomaten je Anfangsbyte, danach zusammengelegt
+    DFA* dfa = new DFA;
+    ShardedBuilder builder;
+    
+    std::string word;
+    while (std::getline(std::cin,word)) {
+      if (!word.empty() && word[word.size()-1] == '\r') word.erase(word.size()-1);
+      words.push_back(word);
+    }
+    builder(*dfa,words);
+    std::cout << "Built " << builder.shards() << " shards in " << builder.build_time() << "s, merged in "
+              << builder.merge_time() << "s, minimized in " << builder.minimize_time() << "s.\n";
+    if (layout != Renumbering::KEEP) relayout(*dfa,layout,words);
+    finish(*dfa,tasks,engine,words);
+  }
+  else if (tfsm_file){
+    DFA* dfa = new DFA;
+    if (nondeterministic) {
+      //Potenzmengenkonstruktion, das Ergebnis wird wie ein eingelesener DFA weiterverarbeitet
+      NFA nfa;
+      if (!nfa.read(tfsm_file)) {
+        std::cerr << "Error: cannot open " << tfsm_file << "\n";
+        exit(1);
+      }
+      SubsetConstruction determinize;
+      if (!determinize(nfa,*dfa)) exit(1);
+      std::cout << "Determinized " << nfa.number_of_states() << " states (" << nfa.number_of_transitions() << " transitions, "
+                << nfa.number_of_epsilons() << " epsilon) into " << determinize.dfa_states() << " states (blow-up "
+                << determinize.blowup() << ", largest set " << determinize.largest_set() << ") in " << determinize.duration() << "s.\n";
+    }
+    else {
+      TfsmReader read;
+      if (!read(*dfa,tfsm_file)) {
+        std::cerr << "Error: cannot open " << tfsm_file << "\n";
+        exit(1);
+      }
+      std::cout << "Read in " << read.duration() << "s (" << read.throughput() << " MB/s).\n";
+    }
     
     std::cout << *dfa;
     std::cout << std::endl;
-    dfa->draw("test_minimal.dot");
-       
+    dfa->draw("test.dot");
+    if (copies) benchmark_batch(*dfa,copies,engine,classes,trim);
+    run_hopcroft(*dfa,engine,classes,trim,layout,words,stats_file);
+    finish(*dfa,tasks,engine,words);
   }
   else{
     DFA* dfa = new DFA;
     
     std::string word;
-    while (std::cin.good()) {
-      std::getline(std::cin,word);
+    while (std::getline(std::cin,word)) {
+      if (!word.empty() && word[word.size()-1] == '\r') word.erase(word.size()-1);
       dfa->add_word(word);
+      if (tasks.lookups || tasks.hashing || layout == Renumbering::FREQUENCY) words.push_back(word);
     }
     
     std::cout << *dfa;
     std::cout << std::endl;
     dfa->draw("test.dot");
-    
-    Hopcroft* minimize = new Hopcroft;
-    
-    start = clock();
-    (*minimize)(*dfa);
-    end = clock();
-    std::cout << "Minimized in " << (end-start) / CLOCKS_PER_SEC << "s.\n";
-    
-    std::cout << *dfa;
-    std::cout << std::endl;
-    dfa->draw("test_minimal.dot");
+    run_hopcroft(*dfa,engine,classes,trim,layout,words,stats_file);
+    finish(*dfa,tasks,engine,words);
   }
 }
\ No newline at end of file